@@ -30,6 +30,9 @@ typedef NS_ENUM(NSInteger, LocalConnectionStatus)
 /// maybe you only want to observe the local network is available or not.
 @property (nonatomic, assign) BOOL isReachable;
 
+/// Shared by all ReachabilityMonitor instances.
++ (instancetype)sharedInstance;
+
 /**
  * Start observering local connection status.
  */
@@ -47,5 +50,18 @@ typedef NS_ENUM(NSInteger, LocalConnectionStatus)
  */
 - (LocalConnectionStatus)currentLocalConnectionStatus;
 
+/**
+ *  Stateless VPN detection, no observer needed;
+ *  used by RealReachability and ReachabilityMonitor.
+ *
+ *  @return YES if a VPN interface (tap/tun/ipsec/ppp) is connected.
+ */
++ (BOOL)isVPNConnected;
+
+/**
+ *  @return YES if the interface name is one of a VPN (tap/tun/ipsec/ppp).
+ */
++ (BOOL)isVPNInterface:(NSString *)interfaceName;
+
 @end
 
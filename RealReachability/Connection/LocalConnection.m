@@ -11,6 +11,8 @@
 #import <netinet6/in6.h>
 #import <arpa/inet.h>
 #import <ifaddrs.h>
+#import <UIKit/UIKit.h>
+#import <CFNetwork/CFNetwork.h>
 
 #if (!defined(DEBUG))
 #define NSLog(...)
@@ -174,6 +176,61 @@ static NSString *connectionFlags(SCNetworkReachabilityFlags flags)
     }
 }
 
++ (BOOL)isVPNConnected
+{
+    BOOL flag = NO;
+    NSString *version = [UIDevice currentDevice].systemVersion;
+    // need two ways to judge this.
+    if (version.doubleValue >= 9.0)
+    {
+        NSDictionary *dict = CFBridgingRelease(CFNetworkCopySystemProxySettings());
+        NSArray *keys = [dict[@"__SCOPED__"] allKeys];
+        for (NSString *key in keys) {
+            if ([self isVPNInterface:key]){
+                flag = YES;
+                break;
+            }
+        }
+    }
+    else
+    {
+        struct ifaddrs *interfaces = NULL;
+        struct ifaddrs *temp_addr = NULL;
+        int success = 0;
+        
+        // retrieve the current interfaces - returns 0 on success
+        success = getifaddrs(&interfaces);
+        if (success == 0)
+        {
+            // Loop through linked list of interfaces
+            temp_addr = interfaces;
+            while (temp_addr != NULL)
+            {
+                NSString *string = [NSString stringWithFormat:@"%s" , temp_addr->ifa_name];
+                if ([self isVPNInterface:string])
+                {
+                    flag = YES;
+                    break;
+                }
+                temp_addr = temp_addr->ifa_next;
+            }
+        }
+        
+        // Free memory
+        freeifaddrs(interfaces);
+    }
+    
+    return flag;
+}
+
++ (BOOL)isVPNInterface:(NSString *)interfaceName
+{
+    return ([interfaceName rangeOfString:@"tap"].location != NSNotFound ||
+            [interfaceName rangeOfString:@"tun"].location != NSNotFound ||
+            [interfaceName rangeOfString:@"ipsec"].location != NSNotFound ||
+            [interfaceName rangeOfString:@"ppp"].location != NSNotFound);
+}
+
 #pragma mark - inner methods
 
 - (void)localConnectionChanged
@@ -12,6 +12,9 @@
 
 #define kEventKeyID         @"event_id"
 #define kEventKeyParam      @"event_param"
+/// Local connection value (kParamValueXXX) attached to RREventPingCallback,
+/// so that every FSM decides with the local status of its own owner.
+#define kEventKeyLocalParam @"event_local_param"
 
 #define kParamValueUnReachable @"ParamValueUnReachable"
 #define kParamValueWWAN        @"ParamValueWWAN"
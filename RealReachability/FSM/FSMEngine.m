@@ -31,8 +31,13 @@
 {
     if (self = [super init])
     {
-        // created only once
-        _allStates = @[[ReachStateUnloaded state], [ReachStateLoading state], [ReachStateUnReachable state], [ReachStateWIFI state], [ReachStateWWAN state]];
+        // states hold no data, created only once and shared by all engines.
+        static NSArray *sharedStates = nil;
+        static dispatch_once_t onceToken;
+        dispatch_once(&onceToken, ^{
+            sharedStates = @[[ReachStateUnloaded state], [ReachStateLoading state], [ReachStateUnReachable state], [ReachStateWIFI state], [ReachStateWWAN state]];
+        });
+        _allStates = sharedStates;
     }
     return self;
 }
@@ -8,11 +8,23 @@
 
 #import <Foundation/Foundation.h>
 #import "FSMDefines.h"
+#import "LocalConnection.h"
 
 @interface FSMStateUtil : NSObject
 
 + (RRStateID)RRStateFromValue:(NSString *)LCEventValue;
 
-+ (RRStateID)RRStateFromPingFlag:(BOOL)isSuccess;
+/**
+ *  State after a ping callback.
+ *
+ *  @param isSuccess    ping result
+ *  @param LCEventValue local connection value(kParamValueXXX) of the FSM owner
+ *
+ *  @return new state ID
+ */
++ (RRStateID)RRStateFromPingFlag:(BOOL)isSuccess localValue:(NSString *)LCEventValue;
+
+/// Convert local connection status to the event param value(kParamValueXXX).
++ (NSString *)paramValueFromStatus:(LocalConnectionStatus)status;
 
 @end
@@ -7,7 +7,10 @@
 //
 
 #import "FSMStateUtil.h"
-#import "RealReachability.h"
+
+#if (!defined(DEBUG))
+#define NSLog(...)
+#endif
 
 @implementation FSMStateUtil
 
@@ -32,30 +35,26 @@
     }
 }
 
-+ (RRStateID)RRStateFromPingFlag:(BOOL)isSuccess
++ (RRStateID)RRStateFromPingFlag:(BOOL)isSuccess localValue:(NSString *)LCEventValue
 {
-    LocalConnectionStatus status = GLobalRealReachability.localObserver.currentLocalConnectionStatus;
-    
     if (!isSuccess)
     {
         return RRStateUnReachable;
     }
     else
     {
-        switch (status)
+        RRStateID stateID = [self RRStateFromValue:LCEventValue];
+        switch (stateID)
         {
-            case LC_UnReachable:
+            case RRStateUnReachable:
             {
                 NSLog(@"MisMatch! RRStateFromPingFlag success, but LC_UnReachable!");
                 return RRStateUnReachable;
             }
-            case LC_WiFi:
+            case RRStateWIFI:
+            case RRStateWWAN:
             {
-                return RRStateWIFI;
-            }
-            case LC_WWAN:
-            {
-                return RRStateWWAN;
+                return stateID;
             }
                 
             default:
@@ -67,4 +66,29 @@
     }
 }
 
++ (NSString *)paramValueFromStatus:(LocalConnectionStatus)status
+{
+    switch (status)
+    {
+        case LC_UnReachable:
+        {
+            return kParamValueUnReachable;
+        }
+        case LC_WiFi:
+        {
+            return kParamValueWIFI;
+        }
+        case LC_WWAN:
+        {
+            return kParamValueWWAN;
+        }
+            
+        default:
+        {
+            NSLog(@"RealReachability error! paramValueFromStatus not matched!");
+            return @"";
+        }
+    }
+}
+
 @end
@@ -26,7 +26,8 @@
         case RREventPingCallback:
         {
             NSNumber *eventParam = event[kEventKeyParam];
-            resStateID = [FSMStateUtil RRStateFromPingFlag:[eventParam boolValue]];
+            resStateID = [FSMStateUtil RRStateFromPingFlag:[eventParam boolValue]
+                                              localValue:event[kEventKeyLocalParam]];
             break;
         }
         case RREventLocalConnectionCallback:
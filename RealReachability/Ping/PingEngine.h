@@ -0,0 +1,100 @@
+//
+//  PingEngine.h
+//  RealReachability
+//  Probe engine shared by RealReachability and all ReachabilityMonitor instances.
+//
+//  Created by agent on 26/10/19.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+/**
+ *  Servers and middleboxes rate-limit ICMP echo, so pings are paced by token buckets:
+ *  one for all hosts, one for each host. A request over budget reuses a recent successful
+ *  result of its host, otherwise it is queued until tokens are available
+ *  (all of the queued requests of one host are merged into one ping).
+ *  So a failed ping means the network, not our own burst.
+ */
+@interface PingEngine : NSObject
+
+/// Count of hosts held by the engine; one PingHelper per host & interface.
+/// A host nobody asked for since 5 minutes is dropped.
+@property (nonatomic, readonly) NSUInteger hostCount;
+
+/// Pings per second for all hosts; default is 10, at least 0.01.
+@property (nonatomic, assign) double globalPingRate;
+
+/// Pings sent at once for all hosts; default is 10, at least 1.
+@property (nonatomic, assign) double globalPingBurst;
+
+/// Pings per second for each host; default is 1, at least 0.01.
+@property (nonatomic, assign) double hostPingRate;
+
+/// Pings sent at once for each host; default is 3, at least 1.
+@property (nonatomic, assign) double hostPingBurst;
+
+/// Seconds a successful result is reused for requests over budget; default is 2 seconds.
+@property (nonatomic, assign) NSTimeInterval resultReuseInterval;
+
+/// Count of pings really sent.
+@property (nonatomic, readonly) NSUInteger sentCount;
+
+/// Count of requests merged into a ping in flight or answered by a recent result.
+@property (nonatomic, readonly) NSUInteger coalescedCount;
+
+/// Count of requests delayed by the rate limit.
+@property (nonatomic, readonly) NSUInteger throttledCount;
+
++ (instancetype)sharedEngine;
+
+/**
+ *  Ping the host through the helper of this host.
+ *  Concurrent requests for the same host are merged into one ping action,
+ *  so monitors watching the same endpoint send only one ping.
+ *  Different hosts are not merged: each of them opens its own ICMP socket
+ *  while its ping is in flight (closed right after). The pacing below bounds how many
+ *  are open at once, whatever the count of monitors; a shared socket could not be bound
+ *  to the interface of each path anyway.
+ *  The ping may be delayed by the rate limit, see above.
+ *
+ *  @param host       host to ping
+ *  @param timeout    ping timeout, ignored when joining a ping already in flight;
+ *                    a queued ping uses the longest timeout of its requests
+ *  @param completion async completion block, called on main thread
+ *
+ *  @return token for cancelPing:
+ */
+- (id)pingHost:(NSString *)host
+       timeout:(NSTimeInterval)timeout
+    completion:(void (^)(BOOL isSuccess, NSTimeInterval latency))completion;
+
+/**
+ *  Same as pingHost:timeout:completion:, but the ping is bound to one network interface,
+ *  so a path which is not the default route can be measured.
+ *  Each host & interface pair has its own helper and its own host token bucket.
+ *  The host is looked up through the interface itself (scoped DNS), so a dead default route
+ *  does not fail the other paths; the first lookup is part of the ping timeout.
+ *  The last good address of the path is kept, and refreshed in background every minute.
+ *
+ *  @param host          host to ping
+ *  @param interfaceName interface to send through, e.g. en0 or pdp_ip0; nil means the default route
+ *  @param timeout       ping timeout, see pingHost:timeout:completion:
+ *  @param completion    async completion block, called on main thread
+ *
+ *  @return token for cancelPing:
+ */
+- (id)pingHost:(NSString *)host
+     interface:(NSString *)interfaceName
+       timeout:(NSTimeInterval)timeout
+    completion:(void (^)(BOOL isSuccess, NSTimeInterval latency))completion;
+
+/**
+ *  The completion of this token will never be called, even for a reused result;
+ *  the ping action is stopped if no one else is waiting for it.
+ *
+ *  @param token returned by pingHost:timeout:completion:
+ */
+- (void)cancelPing:(id)token;
+
+@end
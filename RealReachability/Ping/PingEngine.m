@@ -0,0 +1,784 @@
+//
+//  PingEngine.m
+//  RealReachability
+//
+//  Created by agent on 26/10/19.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#import "PingEngine.h"
+#import "PingHelper.h"
+#import "TimerWheel.h"
+
+#include <dns_sd.h>
+#include <net/if.h>
+
+#if (!defined(DEBUG))
+#define NSLog(...)
+#endif
+
+#define kDefaultGlobalPingRate 10.0
+#define kDefaultGlobalPingBurst 10.0
+#define kDefaultHostPingRate 1.0
+#define kDefaultHostPingBurst 3.0
+#define kDefaultResultReuseInterval 2.0
+
+/// Lower bounds of the rates & bursts, so a queued request is always sent some day.
+#define kMinPingRate 0.01
+#define kMinPingBurst 1.0
+
+/// A host without request for this long is dropped (seconds).
+#define kHostIdleInterval 300.0
+
+/// The address of a path is refreshed after this long (seconds); until then it is used as is.
+#define kResolveRefreshInterval 60.0
+
+#pragma mark - PingTokenBucket
+
+@interface PingTokenBucket : NSObject
+
+@property (nonatomic, assign) double tokens;
+@property (nonatomic, assign) NSTimeInterval updateTime;
+
+@end
+
+@implementation PingTokenBucket
+
+- (id)init
+{
+    if ((self = [super init]))
+    {
+        // full at first.
+        _tokens = -1;
+    }
+    return self;
+}
+
+- (void)refillWithRate:(double)rate burst:(double)burst now:(NSTimeInterval)now
+{
+    if (self.tokens < 0)
+    {
+        self.tokens = burst;
+    }
+    else if (now > self.updateTime)
+    {
+        self.tokens = MIN(burst, self.tokens + (now - self.updateTime) * rate);
+    }
+    self.updateTime = now;
+}
+
+/// Seconds until one token is available, call refill first.
+- (NSTimeInterval)delayWithRate:(double)rate
+{
+    if (self.tokens >= 1)
+    {
+        return 0;
+    }
+    return (rate > 0) ? (1 - self.tokens) / rate : DBL_MAX;
+}
+
+@end
+
+#pragma mark - PingEngineHost
+
+/// Everything the engine keeps for one host, touched on main thread only.
+@interface PingEngineHost : NSObject
+
+@property (nonatomic, strong) PingHelper *helper;
+@property (nonatomic, strong) PingTokenBucket *bucket;
+
+/// Requests waiting for tokens or for the address, all of them join one ping when released.
+@property (nonatomic, strong) NSMutableArray *waitingTokens;
+/// YES while in the queue of the engine.
+@property (nonatomic, assign) BOOL isQueued;
+
+@property (nonatomic, assign) NSTimeInterval lastSuccessTime;
+@property (nonatomic, assign) NSTimeInterval lastSuccessLatency;
+@property (nonatomic, assign) NSTimeInterval lastUseTime;
+
+/// Interface-bound hosts only: the last good address resolved through the interface.
+@property (nonatomic, copy) NSData *address;
+@property (nonatomic, assign) NSTimeInterval resolvedTime;
+
+/// Scoped DNS lookup in flight, NULL if none.
+@property (nonatomic, assign) DNSServiceRef lookup;
+@property (nonatomic, assign) TimerWheelHandle lookupTimer;
+@property (nonatomic, copy) void (^lookupHandler)(NSData *address);
+
+/// YES while the waiting requests wait for the first address; the lookup is part of their ping budget.
+@property (nonatomic, assign) BOOL isWaitingForAddress;
+/// Uptime when the waiting requests run out of time.
+@property (nonatomic, assign) NSTimeInterval pingDeadline;
+
+@end
+
+@implementation PingEngineHost
+
+- (void)dealloc
+{
+    [[TimerWheel sharedWheel] cancelTimer:_lookupTimer];
+    if (_lookup != NULL)
+    {
+        DNSServiceRefDeallocate(_lookup);
+    }
+}
+
+@end
+
+/// Reply of the scoped lookup, on main queue; the first address wins, a real error ends the lookup.
+static void PingEngineLookupReply(DNSServiceRef sdRef, DNSServiceFlags flags, uint32_t interfaceIndex,
+                                  DNSServiceErrorType errorCode, const char *hostname,
+                                  const struct sockaddr *address, uint32_t ttl, void *context)
+{
+    PingEngineHost *engineHost = (__bridge PingEngineHost *)context;
+    NSData *addressData = nil;
+    if (errorCode == kDNSServiceErr_NoError)
+    {
+        if (!(flags & kDNSServiceFlagsAdd) || address == NULL ||
+            (address->sa_family != AF_INET && address->sa_family != AF_INET6))
+        {
+            // a removed or unusable record, wait for the next one.
+            return;
+        }
+        addressData = [NSData dataWithBytes:address length:address->sa_len];
+    }
+    
+    // the handler releases itself when it ends the lookup, keep it alive until it returns.
+    void (^lookupHandler)(NSData *address) = engineHost.lookupHandler;
+    if (lookupHandler != nil)
+    {
+        lookupHandler(addressData);
+    }
+}
+
+#pragma mark - PingEngineToken
+
+/// Token of one request.
+@interface PingEngineToken : NSObject
+
+/// Set on main thread when the request is handled.
+@property (nonatomic, strong) PingEngineHost *host;
+@property (nonatomic, assign) NSTimeInterval timeout;
+
+/// The exact block object added to the helper, kept for cancelPingWithBlock:.
+@property (nonatomic, copy) void (^helperBlock)(BOOL isSuccess, NSTimeInterval latency);
+
+- (instancetype)initWithCompletion:(void (^)(BOOL isSuccess, NSTimeInterval latency))completion;
+- (BOOL)isCancelled;
+- (void)cancel;
+- (void)finishWithSuccess:(BOOL)isSuccess latency:(NSTimeInterval)latency;
+
+@end
+
+@implementation PingEngineToken
+{
+    // guarded by @synchronized(self), cancel may come from any thread.
+    BOOL _isCancelled;
+    void (^_completion)(BOOL isSuccess, NSTimeInterval latency);
+}
+
+- (instancetype)initWithCompletion:(void (^)(BOOL isSuccess, NSTimeInterval latency))completion
+{
+    if ((self = [super init]))
+    {
+        _completion = [completion copy];
+    }
+    return self;
+}
+
+- (BOOL)isCancelled
+{
+    @synchronized(self)
+    {
+        return _isCancelled;
+    }
+}
+
+- (void)cancel
+{
+    @synchronized(self)
+    {
+        _isCancelled = YES;
+        _completion = nil;
+    }
+}
+
+/// Call the completion once; never after cancel.
+- (void)finishWithSuccess:(BOOL)isSuccess latency:(NSTimeInterval)latency
+{
+    void (^completion)(BOOL isSuccess, NSTimeInterval latency) = nil;
+    @synchronized(self)
+    {
+        completion = _completion;
+        _completion = nil;
+    }
+    
+    // break the cycle token -> helperBlock -> token.
+    self.helperBlock = nil;
+    
+    if (completion != nil)
+    {
+        completion(isSuccess, latency);
+    }
+}
+
+@end
+
+#pragma mark - PingEngine
+
+@interface PingEngine()
+
+/// host (or host%interface) -> PingEngineHost
+@property (nonatomic, strong) NSMutableDictionary *hosts;
+@property (nonatomic, strong) PingTokenBucket *globalBucket;
+
+/// Hosts with waiting requests, in arrival order; drained by one timer.
+@property (nonatomic, strong) NSMutableArray *queuedHosts;
+@property (nonatomic, assign) TimerWheelHandle queueTimer;
+@property (nonatomic, assign) TimerWheelHandle sweepTimer;
+
+@property (nonatomic, assign, readwrite) NSUInteger sentCount;
+@property (nonatomic, assign, readwrite) NSUInteger coalescedCount;
+@property (nonatomic, assign, readwrite) NSUInteger throttledCount;
+
+@end
+
+@implementation PingEngine
+
+#pragma mark - Life Circle
+
+- (id)init
+{
+    if ((self = [super init]))
+    {
+        _hosts = [NSMutableDictionary dictionary];
+        _globalBucket = [[PingTokenBucket alloc] init];
+        _queuedHosts = [NSMutableArray array];
+    
+        _globalPingRate = kDefaultGlobalPingRate;
+        _globalPingBurst = kDefaultGlobalPingBurst;
+        _hostPingRate = kDefaultHostPingRate;
+        _hostPingBurst = kDefaultHostPingBurst;
+        _resultReuseInterval = kDefaultResultReuseInterval;
+    }
+    return self;
+}
+
+#pragma mark - Singlton Method
+
++ (instancetype)sharedEngine
+{
+    static id sharedEngine = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        sharedEngine = [[self alloc] init];
+    });
+    
+    return sharedEngine;
+}
+
+#pragma mark - actions
+
+- (id)pingHost:(NSString *)host
+       timeout:(NSTimeInterval)timeout
+    completion:(void (^)(BOOL isSuccess, NSTimeInterval latency))completion
+{
+    return [self pingHost:host interface:nil timeout:timeout completion:completion];
+}
+
+- (id)pingHost:(NSString *)host
+     interface:(NSString *)interfaceName
+       timeout:(NSTimeInterval)timeout
+    completion:(void (^)(BOOL isSuccess, NSTimeInterval latency))completion
+{
+    if ([host length] <= 0)
+    {
+        NSLog(@"PingEngine error! empty host!");
+        if (completion != nil)
+        {
+            completion(NO, 0);
+        }
+        return nil;
+    }
+    
+    PingEngineToken *token = [[PingEngineToken alloc] initWithCompletion:completion];
+    token.timeout = timeout;
+    
+    // MUST make sure the decision and the join are one step in mainThread,
+    // so the ping in flight can not end in between.
+    if ([[NSThread currentThread] isMainThread])
+    {
+        [self handleToken:token host:host interface:interfaceName];
+    }
+    else
+    {
+        __weak __typeof(self)weakSelf = self;
+        dispatch_async(dispatch_get_main_queue(), ^{
+            __strong __typeof(weakSelf)strongSelf = weakSelf;
+            [strongSelf handleToken:token host:host interface:interfaceName];
+        });
+    }
+    
+    return token;
+}
+
+- (void)cancelPing:(id)token
+{
+    if (![token isKindOfClass:[PingEngineToken class]])
+    {
+        return;
+    }
+    
+    // never called from now on, whatever thread the result comes from.
+    PingEngineToken *engineToken = (PingEngineToken *)token;
+    [engineToken cancel];
+    
+    if ([[NSThread currentThread] isMainThread])
+    {
+        [self removeCancelledToken:engineToken];
+    }
+    else
+    {
+        __weak __typeof(self)weakSelf = self;
+        dispatch_async(dispatch_get_main_queue(), ^{
+            __strong __typeof(weakSelf)strongSelf = weakSelf;
+            [strongSelf removeCancelledToken:engineToken];
+        });
+    }
+}
+
+- (void)setGlobalPingRate:(double)globalPingRate
+{
+    _globalPingRate = MAX(globalPingRate, kMinPingRate);
+}
+
+- (void)setGlobalPingBurst:(double)globalPingBurst
+{
+    _globalPingBurst = MAX(globalPingBurst, kMinPingBurst);
+}
+
+- (void)setHostPingRate:(double)hostPingRate
+{
+    _hostPingRate = MAX(hostPingRate, kMinPingRate);
+}
+
+- (void)setHostPingBurst:(double)hostPingBurst
+{
+    _hostPingBurst = MAX(hostPingBurst, kMinPingBurst);
+}
+
+- (NSUInteger)hostCount
+{
+    @synchronized(self)
+    {
+        return self.hosts.count;
+    }
+}
+
+#pragma mark - inner methods
+
+- (PingEngineHost *)engineHostForHost:(NSString *)host interface:(NSString *)interfaceName
+{
+    // scoped like an IPv6 link-local address: host%interface
+    NSString *key = ([interfaceName length] > 0) ? [NSString stringWithFormat:@"%@%%%@", host, interfaceName] : host;
+    @synchronized(self)
+    {
+        PingEngineHost *engineHost = self.hosts[key];
+        if (engineHost == nil)
+        {
+            engineHost = [[PingEngineHost alloc] init];
+            engineHost.helper = [[PingHelper alloc] init];
+            engineHost.helper.interfaceName = interfaceName;
+            engineHost.helper.host = host;
+            engineHost.bucket = [[PingTokenBucket alloc] init];
+            engineHost.waitingTokens = [NSMutableArray array];
+            self.hosts[key] = engineHost;
+        }
+        return engineHost;
+    }
+}
+
+/// Main thread only.
+- (void)handleToken:(PingEngineToken *)token host:(NSString *)host interface:(NSString *)interfaceName
+{
+    if ([token isCancelled])
+    {
+        return;
+    }
+    
+    PingEngineHost *engineHost = [self engineHostForHost:host interface:interfaceName];
+    token.host = engineHost;
+    NSTimeInterval now = [NSProcessInfo processInfo].systemUptime;
+    engineHost.lastUseTime = now;
+    [self armSweepTimer];
+    
+    if (engineHost.waitingTokens.count > 0)
+    {
+        // join the ping queued or being resolved.
+        self.coalescedCount++;
+        [engineHost.waitingTokens addObject:token];
+    }
+    else if (engineHost.helper.isPinging)
+    {
+        // join the ping in flight.
+        self.coalescedCount++;
+        [self addToken:token toHelperOfHost:engineHost];
+    }
+    else if (self.queuedHosts.count == 0 && [self takeTokensForHost:engineHost now:now])
+    {
+        // nobody is queued before us, so the tokens are ours.
+        self.sentCount++;
+        [engineHost.waitingTokens addObject:token];
+        [self sendWaitingTokensOfHost:engineHost];
+    }
+    else if (engineHost.lastSuccessTime > 0 && now - engineHost.lastSuccessTime <= self.resultReuseInterval)
+    {
+        // Only a success is reused: a failure might be caused by our own burst.
+        self.coalescedCount++;
+        NSTimeInterval latency = engineHost.lastSuccessLatency;
+    
+        // keep it async just like a real ping; a cancelled token is never called.
+        dispatch_async(dispatch_get_main_queue(), ^{
+            [token finishWithSuccess:YES latency:latency];
+        });
+    }
+    else
+    {
+        // over budget, or hosts are queued before us: wait behind them in arrival order.
+        [engineHost.waitingTokens addObject:token];
+        engineHost.isQueued = YES;
+        [self.queuedHosts addObject:engineHost];
+        [self drainQueue];
+        if (engineHost.isQueued)
+        {
+            self.throttledCount++;
+        }
+    }
+}
+
+- (void)armSweepTimer
+{
+    if (self.sweepTimer != kTimerWheelInvalidHandle)
+    {
+        return;
+    }
+    
+    __weak __typeof(self)weakSelf = self;
+    self.sweepTimer = [[TimerWheel sharedWheel] armTimerWithDelay:kHostIdleInterval handler:^{
+        __strong __typeof(weakSelf)strongSelf = weakSelf;
+        strongSelf.sweepTimer = kTimerWheelInvalidHandle;
+        [strongSelf sweepIdleHosts];
+    }];
+}
+
+/// Drop the hosts nobody asked for since kHostIdleInterval,
+/// so stopped monitors and changed hosts leave no helper behind.
+- (void)sweepIdleHosts
+{
+    NSTimeInterval now = [NSProcessInfo processInfo].systemUptime;
+    NSUInteger hostCount = 0;
+    @synchronized(self)
+    {
+        NSMutableArray *idleKeys = [NSMutableArray array];
+        [self.hosts enumerateKeysAndObjectsUsingBlock:^(NSString *key, PingEngineHost *engineHost, BOOL *stop) {
+            if (engineHost.waitingTokens.count == 0 && !engineHost.helper.isPinging &&
+                engineHost.lookup == NULL && now - engineHost.lastUseTime >= kHostIdleInterval)
+            {
+                [idleKeys addObject:key];
+            }
+        }];
+        [self.hosts removeObjectsForKeys:idleKeys];
+        hostCount = self.hosts.count;
+    }
+    
+    if (hostCount > 0)
+    {
+        [self armSweepTimer];
+    }
+}
+
+/// Main thread only.
+- (void)removeCancelledToken:(PingEngineToken *)token
+{
+    PingEngineHost *engineHost = token.host;
+    if (engineHost == nil)
+    {
+        // not handled yet, handleToken: will skip it.
+        return;
+    }
+    
+    if ([engineHost.waitingTokens containsObject:token])
+    {
+        [engineHost.waitingTokens removeObjectIdenticalTo:token];
+        if (engineHost.waitingTokens.count == 0 && engineHost.isQueued)
+        {
+            engineHost.isQueued = NO;
+            [self.queuedHosts removeObjectIdenticalTo:engineHost];
+        }
+        else if (engineHost.waitingTokens.count == 0 && engineHost.isWaitingForAddress)
+        {
+            // nobody waits for the address, release the lookup at once.
+            engineHost.isWaitingForAddress = NO;
+            [self stopLookupOfHost:engineHost];
+        }
+        return;
+    }
+    
+    if (token.helperBlock != nil)
+    {
+        [engineHost.helper cancelPingWithBlock:token.helperBlock];
+        token.helperBlock = nil;
+    }
+}
+
+/// Take one token from the global bucket and the host bucket, or none.
+- (BOOL)takeTokensForHost:(PingEngineHost *)engineHost now:(NSTimeInterval)now
+{
+    [self.globalBucket refillWithRate:self.globalPingRate burst:self.globalPingBurst now:now];
+    [engineHost.bucket refillWithRate:self.hostPingRate burst:self.hostPingBurst now:now];
+    
+    if (self.globalBucket.tokens < 1 || engineHost.bucket.tokens < 1)
+    {
+        return NO;
+    }
+    
+    self.globalBucket.tokens -= 1;
+    engineHost.bucket.tokens -= 1;
+    return YES;
+}
+
+/// Release the queued hosts in arrival order, then wait for the next token with one timer.
+/// A host blocked by its own bucket does not block the hosts behind it.
+- (void)drainQueue
+{
+    [[TimerWheel sharedWheel] cancelTimer:self.queueTimer];
+    self.queueTimer = kTimerWheelInvalidHandle;
+    
+    NSTimeInterval now = [NSProcessInfo processInfo].systemUptime;
+    NSTimeInterval delay = DBL_MAX;
+    NSUInteger index = 0;
+    while (index < self.queuedHosts.count)
+    {
+        PingEngineHost *engineHost = self.queuedHosts[index];
+        [self.globalBucket refillWithRate:self.globalPingRate burst:self.globalPingBurst now:now];
+        [engineHost.bucket refillWithRate:self.hostPingRate burst:self.hostPingBurst now:now];
+    
+        if (self.globalBucket.tokens < 1)
+        {
+            delay = MIN(delay, [self.globalBucket delayWithRate:self.globalPingRate]);
+            break;
+        }
+    
+        if (engineHost.bucket.tokens < 1)
+        {
+            delay = MIN(delay, [engineHost.bucket delayWithRate:self.hostPingRate]);
+            index++;
+            continue;
+        }
+    
+        self.globalBucket.tokens -= 1;
+        engineHost.bucket.tokens -= 1;
+        self.sentCount++;
+    
+        engineHost.isQueued = NO;
+        [self.queuedHosts removeObjectAtIndex:index];
+        [self sendWaitingTokensOfHost:engineHost];
+    }
+    
+    if (self.queuedHosts.count > 0 && delay < DBL_MAX)
+    {
+        __weak __typeof(self)weakSelf = self;
+        self.queueTimer = [[TimerWheel sharedWheel] armTimerWithDelay:delay handler:^{
+            __strong __typeof(weakSelf)strongSelf = weakSelf;
+            strongSelf.queueTimer = kTimerWheelInvalidHandle;
+            [strongSelf drainQueue];
+        }];
+    }
+}
+
+/// Start one ping for all of the waiting requests, with the longest timeout of them.
+/// A host on the default route is resolved by its helper within the ping timeout,
+/// so a DNS outage is a failed ping just like before.
+/// An interface-bound host is resolved through its own interface, see resolveHost:.
+- (void)sendWaitingTokensOfHost:(PingEngineHost *)engineHost
+{
+    NSTimeInterval timeout = [self timeoutOfWaitingTokensOfHost:engineHost];
+    if ([engineHost.helper.interfaceName length] <= 0)
+    {
+        [self pingWaitingTokensOfHost:engineHost timeout:timeout];
+        return;
+    }
+    
+    NSTimeInterval now = [NSProcessInfo processInfo].systemUptime;
+    if (engineHost.address != nil)
+    {
+        if (now - engineHost.resolvedTime >= kResolveRefreshInterval)
+        {
+            [self resolveHost:engineHost timeout:timeout];
+        }
+        engineHost.helper.hostAddress = engineHost.address;
+        [self pingWaitingTokensOfHost:engineHost timeout:timeout];
+        return;
+    }
+    
+    // never resolved on this path: the lookup takes its time from the ping budget.
+    // Requests arriving meanwhile join the waiting ones.
+    engineHost.isWaitingForAddress = YES;
+    engineHost.pingDeadline = now + timeout;
+    [self resolveHost:engineHost timeout:timeout];
+}
+
+- (NSTimeInterval)timeoutOfWaitingTokensOfHost:(PingEngineHost *)engineHost
+{
+    NSTimeInterval timeout = 0;
+    for (PingEngineToken *token in engineHost.waitingTokens)
+    {
+        timeout = MAX(timeout, token.timeout);
+    }
+    return timeout;
+}
+
+- (void)pingWaitingTokensOfHost:(PingEngineHost *)engineHost timeout:(NSTimeInterval)timeout
+{
+    NSArray *tokens = [engineHost.waitingTokens copy];
+    [engineHost.waitingTokens removeAllObjects];
+    
+    if (timeout <= 0)
+    {
+        // the budget is gone.
+        for (PingEngineToken *token in tokens)
+        {
+            [token finishWithSuccess:NO latency:0];
+        }
+        return;
+    }
+    
+    engineHost.helper.timeout = timeout;
+    NSMutableArray *blocks = [NSMutableArray arrayWithCapacity:tokens.count];
+    for (PingEngineToken *token in tokens)
+    {
+        [blocks addObject:[self helperBlockOfToken:token host:engineHost]];
+    }
+    if (blocks.count > 0)
+    {
+        [engineHost.helper pingWithBlocks:blocks];
+    }
+}
+
+/// Look the host up through the interface of its path (scoped DNS), bounded by timeout.
+/// So a dead default route (no DNS) does not fail the other paths, even on the first ping.
+/// The last good address is kept when a refresh fails.
+- (void)resolveHost:(PingEngineHost *)engineHost timeout:(NSTimeInterval)timeout
+{
+    if (engineHost.lookup != NULL)
+    {
+        return;
+    }
+    
+    __weak __typeof(self)weakSelf = self;
+    __weak __typeof(engineHost)weakHost = engineHost;
+    engineHost.lookupHandler = ^(NSData *address) {
+        __strong __typeof(weakSelf)strongSelf = weakSelf;
+        __strong __typeof(weakHost)strongHost = weakHost;
+        [strongSelf finishLookupOfHost:strongHost address:address];
+    };
+    
+    uint32_t interfaceIndex = if_nametoindex(engineHost.helper.interfaceName.UTF8String);
+    DNSServiceRef lookup = NULL;
+    DNSServiceErrorType err = kDNSServiceErr_BadParam;
+    if (interfaceIndex != 0)
+    {
+        err = DNSServiceGetAddrInfo(&lookup, 0, interfaceIndex, 0, engineHost.helper.host.UTF8String,
+                                    PingEngineLookupReply, (__bridge void *)engineHost);
+    }
+    if (err == kDNSServiceErr_NoError)
+    {
+        err = DNSServiceSetDispatchQueue(lookup, dispatch_get_main_queue());
+    }
+    if (err != kDNSServiceErr_NoError)
+    {
+        // no such interface (any more), or no resolver.
+        NSLog(@"PingEngine error! lookup of %@ on %@ failed: %d", engineHost.helper.host, engineHost.helper.interfaceName, err);
+        if (lookup != NULL)
+        {
+            DNSServiceRefDeallocate(lookup);
+        }
+        [self finishLookupOfHost:engineHost address:nil];
+        return;
+    }
+    
+    engineHost.lookup = lookup;
+    engineHost.lookupTimer = [[TimerWheel sharedWheel] armTimerWithDelay:timeout handler:^{
+        __strong __typeof(weakSelf)strongSelf = weakSelf;
+        __strong __typeof(weakHost)strongHost = weakHost;
+        strongHost.lookupTimer = kTimerWheelInvalidHandle;
+        [strongSelf finishLookupOfHost:strongHost address:nil];
+    }];
+}
+
+- (void)stopLookupOfHost:(PingEngineHost *)engineHost
+{
+    [[TimerWheel sharedWheel] cancelTimer:engineHost.lookupTimer];
+    engineHost.lookupTimer = kTimerWheelInvalidHandle;
+    engineHost.lookupHandler = nil;
+    
+    if (engineHost.lookup != NULL)
+    {
+        DNSServiceRefDeallocate(engineHost.lookup);
+        engineHost.lookup = NULL;
+    }
+}
+
+/// Called once per lookup: with the address, or nil on error or timeout.
+- (void)finishLookupOfHost:(PingEngineHost *)engineHost address:(NSData *)address
+{
+    if (engineHost == nil)
+    {
+        return;
+    }
+    
+    [self stopLookupOfHost:engineHost];
+    if (address != nil)
+    {
+        engineHost.address = address;
+        engineHost.resolvedTime = [NSProcessInfo processInfo].systemUptime;
+    }
+    
+    if (!engineHost.isWaitingForAddress)
+    {
+        // a refresh in background, or nobody waits any more.
+        return;
+    }
+    engineHost.isWaitingForAddress = NO;
+    
+    // no address: fail the waiting requests at once, they can not be pinged.
+    NSTimeInterval timeout = 0;
+    if (engineHost.address != nil)
+    {
+        engineHost.helper.hostAddress = engineHost.address;
+        timeout = engineHost.pingDeadline - [NSProcessInfo processInfo].systemUptime;
+    }
+    [self pingWaitingTokensOfHost:engineHost timeout:timeout];
+}
+
+- (void)addToken:(PingEngineToken *)token toHelperOfHost:(PingEngineHost *)engineHost
+{
+    [engineHost.helper pingWithBlock:[self helperBlockOfToken:token host:engineHost]];
+}
+
+- (void (^)(BOOL, NSTimeInterval))helperBlockOfToken:(PingEngineToken *)token host:(PingEngineHost *)engineHost
+{
+    __weak __typeof(engineHost)weakHost = engineHost;
+    token.helperBlock = ^(BOOL isSuccess, NSTimeInterval latency) {
+        __strong __typeof(weakHost)strongHost = weakHost;
+        if (isSuccess && strongHost != nil)
+        {
+            strongHost.lastSuccessTime = [NSProcessInfo processInfo].systemUptime;
+            strongHost.lastSuccessLatency = latency;
+        }
+        [token finishWithSuccess:isSuccess latency:latency];
+    };
+    return token.helperBlock;
+}
+
+@end
@@ -82,7 +82,14 @@ typedef NS_ENUM(NSInteger, PingFoundationAddressStyle) {
 
 - (instancetype)initWithHostName:(NSString *)hostName NS_DESIGNATED_INITIALIZER;
 
-/*! A copy of the value passed to `-initWithHostName:`.
+/*! Initialise the object to ping the specified address, without any name-to-address resolution.
+ *  \param hostAddress The address to ping; the contents is a (struct sockaddr) of some form.
+ *  \returns The initialised object.
+ */
+
+- (instancetype)initWithHostAddress:(NSData *)hostAddress NS_DESIGNATED_INITIALIZER;
+
+/*! A copy of the value passed to `-initWithHostName:`, nil if created with an address.
  */
 
 @property (nonatomic, copy, readonly) NSString * hostName;
@@ -100,6 +107,14 @@ typedef NS_ENUM(NSInteger, PingFoundationAddressStyle) {
 
 @property (nonatomic, assign, readwrite) PingFoundationAddressStyle addressStyle;
 
+/*! The name of the network interface the socket is bound to, for example "en0" or "pdp_ip0".
+ *  \details You should set this value before starting the object.  If nil (the default)
+ *      the pings follow the route the OS prefers.  If the interface does not exist or
+ *      the socket can not be bound, `-pingFoundation:didFailWithError:` is called.
+ */
+
+@property (nonatomic, copy, readwrite) NSString * interfaceName;
+
 /*! The address being pinged.
  *  \details The contents of the NSData is a (struct sockaddr) of some form.  The
  *      value is nil while the object is stopped and remains nil on start until
@@ -48,10 +48,12 @@
  */
 
 #import "PingFoundation.h"
+#import "PingInterfaceBind.h"
 
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <errno.h>
+#include <unistd.h>
 
 #pragma mark * IPv4 and ICMPv4 On-The-Wire Format
 
@@ -153,6 +155,11 @@ static uint16_t in_cksum(const void *buffer, size_t bufferLen) {
 
 @property (nonatomic, assign, readwrite)           BOOL         nextSequenceNumberHasWrapped;
 
+/*! The address passed to `-initWithHostAddress:`, pinged without resolution.
+ */
+
+@property (nonatomic, copy,   readwrite, nullable) NSData *     suppliedHostAddress;
+
 /*! A host object for name-to-address resolution.
  */
 
@@ -182,6 +189,21 @@ static uint16_t in_cksum(const void *buffer, size_t bufferLen) {
     return self;
 }
 
+- (instancetype)initWithHostAddress:(NSData *)hostAddress
+{
+    if ([hostAddress length] < sizeof(struct sockaddr))
+    {
+        return nil;
+    }
+    
+    self = [super init];
+    if (self != nil) {
+        self->_suppliedHostAddress = [hostAddress copy];
+        self->_identifier = (uint16_t) arc4random();
+    }
+    return self;
+}
+
 - (void)dealloc
 {
     [self stop];
@@ -645,6 +667,16 @@ static void SocketReadCallback(CFSocketRef s, CFSocketCallBackType type, CFDataR
         } break;
     }
     
+    // Bind it to the interface, if any.
+    
+    if ( (err == 0) && (self.interfaceName.length != 0) ) {
+        err = PingBindSocketToInterface(fd, self.hostAddressFamily, self.interfaceName.UTF8String);
+        if (err != 0) {
+            (void) close(fd);
+            fd = -1;
+        }
+    }
+    
     if (err != 0) {
         [self didFailWithError:[NSError errorWithDomain:NSPOSIXErrorDomain code:err userInfo:nil]];
     } else {
@@ -770,6 +802,13 @@ static void HostResolveCallback(CFHostRef theHost, CFHostInfoType typeInfo, cons
     CFHostClientContext context = {0, (__bridge void *)(self), NULL, NULL, NULL};
     CFStreamError       streamError;
     
+    if (self.suppliedHostAddress != nil)
+    {
+        self.hostAddress = self.suppliedHostAddress;
+        [self startWithHostAddress];
+        return;
+    }
+    
     self.host = (CFHostRef)CFAutorelease(CFHostCreateWithName(NULL, (__bridge CFStringRef) self.hostName));
     
     if (self.host == NULL)
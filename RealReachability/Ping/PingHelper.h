@@ -17,9 +17,18 @@
 /// Used as a backup for double checking.
 @property (nonatomic, copy) NSString *hostForCheck;
 
+/// Interface the ping is bound to, e.g. en0 or pdp_ip0; nil means the route the OS prefers.
+@property (nonatomic, copy) NSString *interfaceName;
+
+/// Address of the host (a struct sockaddr) resolved by the caller; if set, host is not resolved again.
+@property (nonatomic, copy) NSData *hostAddress;
+
 /// Ping timeout. Default is 2 seconds
 @property (nonatomic, assign) NSTimeInterval timeout;
 
+/// YES while a ping action is in flight; new blocks will join it.
+@property (nonatomic, assign, readonly) BOOL isPinging;
+
 /**
  *  trigger a ping action with a completion block
  *
@@ -27,4 +36,21 @@
  */
 - (void)pingWithBlock:(void (^)(BOOL isSuccess, NSTimeInterval latency))completion;
 
+/**
+ *  Same as pingWithBlock:, for many blocks at once:
+ *  all of them are added before the ping starts, so an immediate failure reaches every one.
+ *
+ *  @param completions : Async completion blocks
+ */
+- (void)pingWithBlocks:(NSArray *)completions;
+
+/**
+ *  Remove a block added by pingWithBlock:, it will never be called.
+ *  When no block is waiting any more, the ping action is stopped at once
+ *  to release the socket and the host resolution.
+ *
+ *  @param completion : the same block object passed to pingWithBlock:
+ */
+- (void)cancelPingWithBlock:(void (^)(BOOL isSuccess, NSTimeInterval latency))completion;
+
 @end
@@ -8,6 +8,7 @@
 
 #import "PingHelper.h"
 #import "PingFoundation.h"
+#import "TimerWheel.h"
 
 #if (!defined(DEBUG))
 #define NSLog(...)
@@ -17,11 +18,23 @@
 
 @property (nonatomic, strong) NSMutableArray *completionBlocks;
 @property(nonatomic, strong) PingFoundation *pingFoundation;
-@property (nonatomic, assign) BOOL isPinging;
+@property (nonatomic, assign, readwrite) BOOL isPinging;
 @property (nonatomic, assign) CFAbsoluteTime pingStartTime;
 
+/// Timer of the ping in flight; a late timeout of another handle never ends the next ping.
+@property (nonatomic, assign) TimerWheelHandle timeoutTimer;
+
+- (void)pingTimeOut:(TimerWheelHandle)handle;
+
 @end
 
+/// Armed for every ping, so a function rather than a block: no allocation per ping.
+static void PingHelperTimeOut(void *context, TimerWheelHandle handle)
+{
+    PingHelper *helper = (__bridge PingHelper *)context;
+    [helper pingTimeOut:handle];
+}
+
 @implementation PingHelper
 
 #pragma mark - Life Circle
@@ -42,6 +55,7 @@
     [self.completionBlocks removeAllObjects];
     self.completionBlocks = nil;
     
+    [[TimerWheel sharedWheel] cancelTimer:self.timeoutTimer];
     [self clearPingFoundation];
 }
 
@@ -50,10 +64,15 @@
 - (void)pingWithBlock:(void (^)(BOOL isSuccess, NSTimeInterval latency))completion
 {
     //NSLog(@"pingWithBlock");
-    if (completion)
+    [self pingWithBlocks:(completion != nil) ? @[completion] : @[]];
+}
+
+- (void)pingWithBlocks:(NSArray *)completions
+{
+    // copy the blocks, then added to the blocks array.
+    @synchronized(self)
     {
-        // copy the block, then added to the blocks array.
-        @synchronized(self)
+        for (void (^completion)(BOOL, NSTimeInterval) in completions)
         {
             [self.completionBlocks addObject:[completion copy]];
         }
@@ -76,6 +95,41 @@
     }
 }
 
+- (void)cancelPingWithBlock:(void (^)(BOOL isSuccess, NSTimeInterval latency))completion
+{
+    if (completion == nil)
+    {
+        return;
+    }
+    
+    // MUST make sure pingFoundation in mainThread
+    if (![[NSThread currentThread] isMainThread])
+    {
+        __weak __typeof(self)weakSelf = self;
+        dispatch_async(dispatch_get_main_queue(), ^{
+            __strong __typeof(weakSelf)strongSelf = weakSelf;
+            [strongSelf cancelPingWithBlock:completion];
+        });
+        return;
+    }
+    
+    NSUInteger waitingCount = 0;
+    @synchronized(self)
+    {
+        [self.completionBlocks removeObjectIdenticalTo:completion];
+        waitingCount = self.completionBlocks.count;
+    }
+    
+    if (waitingCount == 0 && self.isPinging)
+    {
+        // nobody cares about the result now.
+        [[TimerWheel sharedWheel] cancelTimer:self.timeoutTimer];
+        self.timeoutTimer = kTimerWheelInvalidHandle;
+        self.isPinging = NO;
+        [self clearPingFoundation];
+    }
+}
+
 - (void)clearPingFoundation
 {
     //NSLog(@"clearPingFoundation");
@@ -98,11 +152,24 @@
     self.pingStartTime = CFAbsoluteTimeGetCurrent();
 
     
-    self.pingFoundation = [[PingFoundation alloc] initWithHostName:self.host];
+    if (self.hostAddress != nil)
+    {
+        self.pingFoundation = [[PingFoundation alloc] initWithHostAddress:self.hostAddress];
+    }
+    else
+    {
+        self.pingFoundation = [[PingFoundation alloc] initWithHostName:self.host];
+    }
+    self.pingFoundation.interfaceName = self.interfaceName;
     self.pingFoundation.delegate = self;
     [self.pingFoundation start];
     
-    [self performSelector:@selector(pingTimeOut) withObject:nil afterDelay:self.timeout];
+    // self is not retained: the timer is cancelled in dealloc,
+    // and the engine drops a helper only when it has not pinged for minutes.
+    [[TimerWheel sharedWheel] cancelTimer:self.timeoutTimer];
+    self.timeoutTimer = [[TimerWheel sharedWheel] armTimerWithDelay:self.timeout
+                                                           function:PingHelperTimeOut
+                                                            context:(__bridge void *)self];
 }
 
 - (void)setHost:(NSString *)host
@@ -114,6 +181,7 @@
     self.pingFoundation = nil;
     
     self.pingFoundation = [[PingFoundation alloc] initWithHostName:_host];
+    self.pingFoundation.interfaceName = self.interfaceName;
     
     self.pingFoundation.delegate = self;
 }
@@ -127,6 +195,7 @@
     self.isPinging = YES;
     
     self.pingFoundation = [[PingFoundation alloc] initWithHostName:self.hostForCheck];
+    self.pingFoundation.interfaceName = self.interfaceName;
     self.pingFoundation.delegate = self;
     [self.pingFoundation start];
     
@@ -134,7 +203,8 @@
 
 - (void)endWithFlag:(BOOL)isSuccess
 {
-    [NSObject cancelPreviousPerformRequestsWithTarget:self selector:@selector(pingTimeOut) object:nil];
+    [[TimerWheel sharedWheel] cancelTimer:self.timeoutTimer];
+    self.timeoutTimer = kTimerWheelInvalidHandle;
     
     if (!self.isPinging)
     {
@@ -148,13 +218,20 @@
 
     [self clearPingFoundation];
     
+    for (void (^completion)(BOOL, NSTimeInterval) in [self takeCompletionBlocks])
+    {
+        completion(isSuccess, latency);
+    }
+}
+
+/// Blocks may ping again on this helper, so they are called out of the array and the lock.
+- (NSArray *)takeCompletionBlocks
+{
     @synchronized(self)
     {
-        for (void (^completion)(BOOL, NSTimeInterval) in self.completionBlocks)
-        {
-            completion(isSuccess, latency);
-        }
+        NSArray *completions = [self.completionBlocks copy];
         [self.completionBlocks removeAllObjects];
+        return completions;
     }
 }
 
@@ -187,23 +264,21 @@
 
 #pragma mark - TimeOut handler
 
-- (void)pingTimeOut
+- (void)pingTimeOut:(TimerWheelHandle)handle
 {
-    if (!self.isPinging)
+    // timeout of a finished ping, just ignore it.
+    if (!self.isPinging || handle != self.timeoutTimer)
     {
         return;
     }
     
     self.isPinging = NO;
+    self.timeoutTimer = kTimerWheelInvalidHandle;
     [self clearPingFoundation];
     
-    @synchronized(self)
+    for (void (^completion)(BOOL, NSTimeInterval) in [self takeCompletionBlocks])
     {
-        for (void (^completion)(BOOL, NSTimeInterval) in self.completionBlocks)
-        {
-            completion(NO, self.timeout);
-        }
-        [self.completionBlocks removeAllObjects];
+        completion(NO, self.timeout);
     }
 }
 
@@ -0,0 +1,60 @@
+//
+//  PingInterfaceBind.c
+//  RealReachability
+//
+//  Created by agent on 26/10/19.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "PingInterfaceBind.h"
+
+#include <netinet/in.h>
+#include <net/if.h>
+#include <errno.h>
+#include <string.h>
+
+int PingBindSocketToInterface(int fd, sa_family_t family, const char *interfaceName)
+{
+    int err = 0;
+    
+    if (interfaceName == NULL || interfaceName[0] == '\0')
+    {
+        return EINVAL;
+    }
+    
+    unsigned int index = if_nametoindex(interfaceName);
+    if (index == 0)
+    {
+        return ENXIO;
+    }
+    
+#if defined(IP_BOUND_IF)
+    switch (family)
+    {
+        case AF_INET:
+        {
+            err = setsockopt(fd, IPPROTO_IP, IP_BOUND_IF, &index, sizeof(index));
+            break;
+        }
+        case AF_INET6:
+        {
+            err = setsockopt(fd, IPPROTO_IPV6, IPV6_BOUND_IF, &index, sizeof(index));
+            break;
+        }
+        default:
+        {
+            return EPROTONOSUPPORT;
+        }
+    }
+#elif defined(SO_BINDTODEVICE)
+    // one option for both families.
+    (void) family;
+    err = setsockopt(fd, SOL_SOCKET, SO_BINDTODEVICE, interfaceName, (socklen_t) strlen(interfaceName));
+#else
+    (void) fd;
+    (void) family;
+    return EOPNOTSUPP;
+#endif
+    
+    return (err == 0) ? 0 : errno;
+}
@@ -0,0 +1,35 @@
+//
+//  PingInterfaceBind.h
+//  RealReachability
+//  Binds a ping socket to one network interface, plain C so it builds and runs on Linux too.
+//
+//  Created by agent on 26/10/19.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#ifndef PingInterfaceBind_h
+#define PingInterfaceBind_h
+
+#include <sys/socket.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ *  Bind a socket to a network interface, so it sends and receives through that interface only.
+ *  Uses IP_BOUND_IF / IPV6_BOUND_IF on Apple platforms and SO_BINDTODEVICE on Linux.
+ *
+ *  @param fd            the socket to bind
+ *  @param family        address family of the socket, AF_INET or AF_INET6
+ *  @param interfaceName name of the interface, e.g. en0, pdp_ip0 or veth0; must not be NULL
+ *
+ *  @return 0 on success; ENXIO if the interface does not exist, otherwise an errno value.
+ */
+int PingBindSocketToInterface(int fd, sa_family_t family, const char *interfaceName);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PingInterfaceBind_h */
@@ -0,0 +1,77 @@
+//
+//  TimerWheel.h
+//  RealReachability
+//  Hierarchical timer wheel used by the probe engine for timeouts and scheduling.
+//
+//  Created by agent on 26/10/19.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+/// Identify an armed timer; 0 is never returned by armTimer.
+typedef uint64_t TimerWheelHandle;
+
+#define kTimerWheelInvalidHandle ((TimerWheelHandle)0)
+
+/// Handler of armTimerWithDelay:function:context:, given the handle the arm returned.
+typedef void (*TimerWheelFunction)(void *context, TimerWheelHandle handle);
+
+/**
+ *  Four levels of 64 slots with 1 millisecond ticks, covering about 4.6 hours;
+ *  longer delays are re-cascaded until they expire.
+ *  Arm and cancel are O(1), nodes come from a pool. A function timer allocates nothing,
+ *  a block timer copies its handler (one heap block if it captures anything).
+ *  All timers expired in one wake are fired as a batch.
+ *
+ *  Arm, cancel and expiry are serialized by one lock: once cancelTimer returns YES,
+ *  the handler will never run; once it returns NO, the handler has run or will still run.
+ *  The batch is taken off the wheel before it runs, so a handler cancelling a later timer
+ *  of the same batch gets NO and that timer still fires: check your own state in handlers.
+ */
+@interface TimerWheel : NSObject
+
+/// Count of timers armed but not fired or cancelled yet.
+@property (nonatomic, readonly) NSUInteger armedCount;
+
+/// Wheel firing its handlers on the main queue, shared by the probe engine.
++ (instancetype)sharedWheel;
+
+/**
+ *  Create a wheel.
+ *
+ *  @param queue queue for the handlers, must be serial; main queue if nil.
+ */
+- (instancetype)initWithQueue:(dispatch_queue_t)queue;
+
+/**
+ *  Arm a one-shot timer.
+ *
+ *  @param delay   delay in seconds, rounded up to milliseconds.
+ *  @param handler called on the queue of the wheel.
+ *
+ *  @return handle for cancelTimer.
+ */
+- (TimerWheelHandle)armTimerWithDelay:(NSTimeInterval)delay handler:(dispatch_block_t)handler;
+
+/**
+ *  Arm a one-shot timer calling a function, for timers armed per packet:
+ *  nothing is copied or retained, so no allocation per timer.
+ *
+ *  @param delay    delay in seconds, rounded up to milliseconds.
+ *  @param function called on the queue of the wheel.
+ *  @param context  passed to function, not retained: it MUST stay valid
+ *                  until the timer fired or cancelTimer returned YES.
+ *
+ *  @return handle for cancelTimer, also passed to function.
+ */
+- (TimerWheelHandle)armTimerWithDelay:(NSTimeInterval)delay function:(TimerWheelFunction)function context:(void *)context;
+
+/**
+ *  Cancel an armed timer.
+ *
+ *  @return YES if the timer was cancelled before firing.
+ */
+- (BOOL)cancelTimer:(TimerWheelHandle)handle;
+
+@end
@@ -0,0 +1,590 @@
+//
+//  TimerWheel.m
+//  RealReachability
+//
+//  Created by agent on 26/10/19.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#import "TimerWheel.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <mach/mach_time.h>
+
+#pragma mark * Wheel core
+
+#define kWheelLevels    4
+#define kWheelSlotBits  6
+#define kWheelSlots     (1 << kWheelSlotBits)
+#define kWheelSlotMask  (kWheelSlots - 1)
+
+/// Longest delta the wheel can place directly, in ticks.
+#define kWheelMaxDelta  ((1ULL << (kWheelLevels * kWheelSlotBits)) - 1)
+
+#define kWheelNil       UINT32_MAX
+
+/*! One timer, living in the node pool.
+ *  \details Nodes are linked by index, so the pool may grow with realloc.
+ *      A free node has level == -1 and is linked into the free list by `next`.
+ *      `handler` is the retained block when `function` is NULL, its context otherwise.
+ */
+
+typedef struct {
+    uint64_t            expires;
+    uint32_t            next;
+    uint32_t            prev;
+    uint32_t            generation;
+    int8_t              level;
+    uint8_t             slot;
+    TimerWheelFunction  function;
+    void *              handler;
+} WheelNode;
+
+/// One expired timer, taken off the wheel under the lock and fired after it.
+typedef struct {
+    TimerWheelFunction  function;
+    void *              handler;
+    uint64_t            handle;
+} WheelExpired;
+
+typedef struct {
+    uint64_t    now;
+    WheelNode * nodes;
+    uint32_t    capacity;
+    uint32_t    freeHead;
+    uint32_t    count;
+    uint32_t    heads[kWheelLevels][kWheelSlots];
+    uint64_t    occupied[kWheelLevels];
+} WheelCore;
+
+static void WheelCoreInit(WheelCore *core)
+{
+    memset(core, 0, sizeof(*core));
+    memset(core->heads, 0xff, sizeof(core->heads));
+    core->freeHead = kWheelNil;
+}
+
+static void WheelCoreDestroy(WheelCore *core)
+{
+    free(core->nodes);
+    core->nodes = NULL;
+    core->capacity = 0;
+}
+
+static BOOL WheelCoreGrow(WheelCore *core)
+{
+    uint32_t newCapacity = (core->capacity == 0) ? 64 : core->capacity * 2;
+    if (newCapacity <= core->capacity || newCapacity == kWheelNil)
+    {
+        return NO;
+    }
+
+    WheelNode *nodes = realloc(core->nodes, sizeof(WheelNode) * newCapacity);
+    if (nodes == NULL)
+    {
+        return NO;
+    }
+
+    // link the new nodes into the free list, lowest index first.
+    for (uint32_t i = newCapacity; i > core->capacity; i--)
+    {
+        WheelNode *node = &nodes[i - 1];
+        node->level = -1;
+        node->generation = 1;
+        node->function = NULL;
+        node->handler = NULL;
+        node->next = core->freeHead;
+        core->freeHead = i - 1;
+    }
+
+    core->nodes = nodes;
+    core->capacity = newCapacity;
+    return YES;
+}
+
+static void WheelCoreLink(WheelCore *core, uint32_t index)
+{
+    WheelNode *node = &core->nodes[index];
+    uint64_t delta = (node->expires > core->now) ? (node->expires - core->now) : 0;
+    uint64_t placed = node->expires;
+    if (delta > kWheelMaxDelta)
+    {
+        // too far away, park it at the farthest place and re-cascade later.
+        delta = kWheelMaxDelta;
+        placed = core->now + kWheelMaxDelta;
+    }
+
+    int level = 0;
+    while (level < kWheelLevels - 1 && delta >= (1ULL << ((level + 1) * kWheelSlotBits)))
+    {
+        level++;
+    }
+
+    uint8_t slot = (uint8_t)((placed >> (level * kWheelSlotBits)) & kWheelSlotMask);
+    node->level = (int8_t)level;
+    node->slot = slot;
+    node->prev = kWheelNil;
+    node->next = core->heads[level][slot];
+    if (node->next != kWheelNil)
+    {
+        core->nodes[node->next].prev = index;
+    }
+    core->heads[level][slot] = index;
+    core->occupied[level] |= (1ULL << slot);
+}
+
+static void WheelCoreUnlink(WheelCore *core, uint32_t index)
+{
+    WheelNode *node = &core->nodes[index];
+    if (node->prev != kWheelNil)
+    {
+        core->nodes[node->prev].next = node->next;
+    }
+    else
+    {
+        core->heads[node->level][node->slot] = node->next;
+        if (node->next == kWheelNil)
+        {
+            core->occupied[node->level] &= ~(1ULL << node->slot);
+        }
+    }
+
+    if (node->next != kWheelNil)
+    {
+        core->nodes[node->next].prev = node->prev;
+    }
+}
+
+static void WheelCoreRelease(WheelCore *core, uint32_t index)
+{
+    WheelNode *node = &core->nodes[index];
+    node->level = -1;
+    node->function = NULL;
+    node->handler = NULL;
+    node->generation++;
+    if (node->generation == 0)
+    {
+        node->generation = 1;
+    }
+    node->next = core->freeHead;
+    core->freeHead = index;
+    core->count--;
+}
+
+/// Returns 0 when out of memory.
+static uint64_t WheelCoreArm(WheelCore *core, uint64_t expires, TimerWheelFunction function, void *handler)
+{
+    if (core->freeHead == kWheelNil && !WheelCoreGrow(core))
+    {
+        return 0;
+    }
+
+    uint32_t index = core->freeHead;
+    WheelNode *node = &core->nodes[index];
+    core->freeHead = node->next;
+    core->count++;
+
+    // never place a timer into the slot of the current tick, it has been processed.
+    node->expires = (expires > core->now) ? expires : core->now + 1;
+    node->function = function;
+    node->handler = handler;
+    WheelCoreLink(core, index);
+
+    return ((uint64_t)node->generation << 32) | index;
+}
+
+/// Returns NO if the timer is not armed any more; otherwise the function and handler
+/// of the cancelled timer are returned through the optional pointers.
+static BOOL WheelCoreCancel(WheelCore *core, uint64_t handle, TimerWheelFunction *function, void **handler)
+{
+    uint32_t index = (uint32_t)(handle & 0xffffffff);
+    uint32_t generation = (uint32_t)(handle >> 32);
+    if (index >= core->capacity)
+    {
+        return NO;
+    }
+
+    WheelNode *node = &core->nodes[index];
+    if (node->level < 0 || node->generation != generation)
+    {
+        return NO;
+    }
+
+    if (function != NULL)
+    {
+        *function = node->function;
+    }
+    if (handler != NULL)
+    {
+        *handler = node->handler;
+    }
+    WheelCoreUnlink(core, index);
+    WheelCoreRelease(core, index);
+    return YES;
+}
+
+/// Tick of the next slot to process (expiry or cascade), UINT64_MAX if the wheel is empty.
+static uint64_t WheelCoreNextTick(const WheelCore *core)
+{
+    uint64_t next = UINT64_MAX;
+    for (int level = 0; level < kWheelLevels; level++)
+    {
+        uint64_t occupied = core->occupied[level];
+        if (occupied == 0)
+        {
+            continue;
+        }
+
+        int shift = level * kWheelSlotBits;
+        uint64_t block = core->now >> shift;
+        uint32_t current = (uint32_t)(block & kWheelSlotMask);
+
+        // slots after the current one in this round, otherwise the first one in the next round.
+        uint64_t after = (current == kWheelSlotMask) ? 0 : (occupied & (~0ULL << (current + 1)));
+        uint64_t distance;
+        if (after != 0)
+        {
+            distance = (uint64_t)__builtin_ctzll(after) - current;
+        }
+        else
+        {
+            distance = kWheelSlots - current + (uint64_t)__builtin_ctzll(occupied);
+        }
+
+        uint64_t tick = (block + distance) << shift;
+        if (tick < next)
+        {
+            next = tick;
+        }
+    }
+    return next;
+}
+
+static void WheelCoreCascade(WheelCore *core, int level)
+{
+    uint32_t slot = (uint32_t)((core->now >> (level * kWheelSlotBits)) & kWheelSlotMask);
+    uint32_t index = core->heads[level][slot];
+    core->heads[level][slot] = kWheelNil;
+    core->occupied[level] &= ~(1ULL << slot);
+
+    while (index != kWheelNil)
+    {
+        uint32_t next = core->nodes[index].next;
+        WheelCoreLink(core, index);
+        index = next;
+    }
+}
+
+/*! Moves the wheel to `target`, collecting the handlers of expired timers.
+ *  \details Empty stretches are skipped with WheelCoreNextTick, so a long sleep costs
+ *      one step per occupied slot rather than one step per tick.
+ *  \param expired Called for every expired timer, in expiry order.
+ *  \param context Passed to `expired`.
+ */
+
+static void WheelCoreAdvance(WheelCore *core, uint64_t target, void (*expired)(const WheelExpired *timer, void *context), void *context)
+{
+    while (core->now < target)
+    {
+        uint64_t next = WheelCoreNextTick(core);
+        if (next > target)
+        {
+            core->now = target;
+            break;
+        }
+        core->now = next;
+
+        // cascade from the lower levels, whose round has just been finished.
+        for (int level = 1; level < kWheelLevels; level++)
+        {
+            if ((core->now & ((1ULL << (level * kWheelSlotBits)) - 1)) != 0)
+            {
+                break;
+            }
+            WheelCoreCascade(core, level);
+        }
+
+        uint32_t slot = (uint32_t)(core->now & kWheelSlotMask);
+        uint32_t index = core->heads[0][slot];
+        core->heads[0][slot] = kWheelNil;
+        core->occupied[0] &= ~(1ULL << slot);
+
+        while (index != kWheelNil)
+        {
+            WheelNode *node = &core->nodes[index];
+            uint32_t next = node->next;
+            if (node->expires > core->now)
+            {
+                // parked beyond kWheelMaxDelta, not yet.
+                WheelCoreLink(core, index);
+            }
+            else
+            {
+                WheelExpired timer = {node->function, node->handler, ((uint64_t)node->generation << 32) | index};
+                WheelCoreRelease(core, index);
+                expired(&timer, context);
+            }
+            index = next;
+        }
+    }
+}
+
+#pragma mark * Expired batch
+
+/*! Timers expired in one wake.
+ *  \details Reserved as large as the node pool when the pool grows,
+ *      so collecting a batch never allocates.
+ */
+
+typedef struct {
+    WheelExpired *  timers;
+    uint32_t        count;
+    uint32_t        capacity;
+} WheelBatch;
+
+static BOOL WheelBatchReserve(WheelBatch *batch, uint32_t capacity)
+{
+    if (capacity <= batch->capacity)
+    {
+        return YES;
+    }
+
+    WheelExpired *timers = realloc(batch->timers, sizeof(WheelExpired) * capacity);
+    if (timers == NULL)
+    {
+        return NO;
+    }
+
+    batch->timers = timers;
+    batch->capacity = capacity;
+    return YES;
+}
+
+static void WheelBatchAppend(const WheelExpired *timer, void *context)
+{
+    WheelBatch *batch = (WheelBatch *)context;
+    if (batch->count < batch->capacity)
+    {
+        batch->timers[batch->count++] = *timer;
+    }
+}
+
+#pragma mark * TimerWheel
+
+@interface TimerWheel()
+{
+    WheelCore _core;
+    WheelBatch _batch;
+    pthread_mutex_t _lock;
+    uint64_t _startTime;
+    mach_timebase_info_data_t _timebase;
+
+    /// Tick the source is scheduled for, UINT64_MAX when idle.
+    uint64_t _scheduledTick;
+}
+
+@property (nonatomic, strong) dispatch_queue_t queue;
+@property (nonatomic, strong) dispatch_source_t source;
+
+@end
+
+@implementation TimerWheel
+
+#pragma mark - Life Circle
+
+- (instancetype)initWithQueue:(dispatch_queue_t)queue
+{
+    if ((self = [super init]))
+    {
+        WheelCoreInit(&_core);
+        pthread_mutex_init(&_lock, NULL);
+        mach_timebase_info(&_timebase);
+        _startTime = mach_absolute_time();
+        _scheduledTick = UINT64_MAX;
+
+        _queue = (queue != nil) ? queue : dispatch_get_main_queue();
+        _source = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, _queue);
+
+        __weak __typeof(self)weakSelf = self;
+        dispatch_source_set_event_handler(_source, ^{
+            __strong __typeof(weakSelf)strongSelf = weakSelf;
+            [strongSelf fire];
+        });
+        dispatch_source_set_timer(_source, DISPATCH_TIME_FOREVER, DISPATCH_TIME_FOREVER, 0);
+        dispatch_resume(_source);
+    }
+    return self;
+}
+
+- (id)init
+{
+    return [self initWithQueue:nil];
+}
+
+- (void)dealloc
+{
+    dispatch_source_cancel(_source);
+
+    // release the block handlers never fired.
+    for (uint32_t i = 0; i < _core.capacity; i++)
+    {
+        if (_core.nodes[i].level >= 0 && _core.nodes[i].function == NULL && _core.nodes[i].handler != NULL)
+        {
+            CFRelease(_core.nodes[i].handler);
+        }
+    }
+    WheelCoreDestroy(&_core);
+    free(_batch.timers);
+    pthread_mutex_destroy(&_lock);
+}
+
+#pragma mark - Singlton Method
+
++ (instancetype)sharedWheel
+{
+    static id sharedWheel = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        sharedWheel = [[self alloc] initWithQueue:dispatch_get_main_queue()];
+    });
+
+    return sharedWheel;
+}
+
+#pragma mark - actions
+
+- (TimerWheelHandle)armTimerWithDelay:(NSTimeInterval)delay handler:(dispatch_block_t)handler
+{
+    if (handler == nil)
+    {
+        return kTimerWheelInvalidHandle;
+    }
+
+    void *retainedHandler = (void *)CFBridgingRetain([handler copy]);
+    TimerWheelHandle handle = [self armTimerWithDelay:delay function:NULL handler:retainedHandler];
+    if (handle == kTimerWheelInvalidHandle)
+    {
+        CFRelease(retainedHandler);
+    }
+    return handle;
+}
+
+- (TimerWheelHandle)armTimerWithDelay:(NSTimeInterval)delay function:(TimerWheelFunction)function context:(void *)context
+{
+    if (function == NULL)
+    {
+        return kTimerWheelInvalidHandle;
+    }
+
+    return [self armTimerWithDelay:delay function:function handler:context];
+}
+
+- (BOOL)cancelTimer:(TimerWheelHandle)handle
+{
+    if (handle == kTimerWheelInvalidHandle)
+    {
+        return NO;
+    }
+
+    TimerWheelFunction function = NULL;
+    void *handler = NULL;
+    pthread_mutex_lock(&_lock);
+    BOOL isCancelled = WheelCoreCancel(&_core, handle, &function, &handler);
+    pthread_mutex_unlock(&_lock);
+
+    if (isCancelled && function == NULL && handler != NULL)
+    {
+        CFRelease(handler);
+    }
+    return isCancelled;
+}
+
+- (NSUInteger)armedCount
+{
+    pthread_mutex_lock(&_lock);
+    NSUInteger count = _core.count;
+    pthread_mutex_unlock(&_lock);
+    return count;
+}
+
+#pragma mark - inner methods
+
+/// `handler` is the retained block when function is NULL, the context otherwise.
+- (TimerWheelHandle)armTimerWithDelay:(NSTimeInterval)delay function:(TimerWheelFunction)function handler:(void *)handler
+{
+    uint64_t delayTicks = (delay > 0) ? (uint64_t)ceil(delay * 1000) : 0;
+
+    pthread_mutex_lock(&_lock);
+    uint64_t handle = WheelCoreArm(&_core, [self currentTick] + delayTicks, function, handler);
+    if (handle != 0 && !WheelBatchReserve(&_batch, _core.capacity))
+    {
+        // the pool has grown but the batch can not follow.
+        WheelCoreCancel(&_core, handle, NULL, NULL);
+        handle = 0;
+    }
+    [self rescheduleLocked];
+    pthread_mutex_unlock(&_lock);
+
+    return handle;
+}
+
+/// Milliseconds since the wheel was created, monotonic.
+- (uint64_t)currentTick
+{
+    uint64_t elapsed = mach_absolute_time() - _startTime;
+    return elapsed * _timebase.numer / _timebase.denom / NSEC_PER_MSEC;
+}
+
+/// MUST hold the lock.
+- (void)rescheduleLocked
+{
+    uint64_t nextTick = WheelCoreNextTick(&_core);
+    if (nextTick == _scheduledTick)
+    {
+        return;
+    }
+    _scheduledTick = nextTick;
+
+    if (nextTick == UINT64_MAX)
+    {
+        dispatch_source_set_timer(self.source, DISPATCH_TIME_FOREVER, DISPATCH_TIME_FOREVER, 0);
+        return;
+    }
+
+    uint64_t currentTick = [self currentTick];
+    int64_t delayNs = (nextTick > currentTick) ? (int64_t)((nextTick - currentTick) * NSEC_PER_MSEC) : 0;
+    dispatch_source_set_timer(self.source, dispatch_time(DISPATCH_TIME_NOW, delayNs), DISPATCH_TIME_FOREVER, NSEC_PER_MSEC);
+}
+
+- (void)fire
+{
+    pthread_mutex_lock(&_lock);
+    _scheduledTick = UINT64_MAX;
+    _batch.count = 0;
+    WheelCoreAdvance(&_core, [self currentTick], WheelBatchAppend, &_batch);
+    uint32_t count = _batch.count;
+    [self rescheduleLocked];
+    pthread_mutex_unlock(&_lock);
+
+    // fire the whole batch outside of the lock, handlers may arm or cancel timers.
+    // An arm may move the batch (realloc), so every timer is read under the lock.
+    for (uint32_t i = 0; i < count; i++)
+    {
+        pthread_mutex_lock(&_lock);
+        WheelExpired timer = _batch.timers[i];
+        pthread_mutex_unlock(&_lock);
+
+        if (timer.function != NULL)
+        {
+            timer.function(timer.handler, timer.handle);
+        }
+        else
+        {
+            dispatch_block_t handler = (__bridge_transfer dispatch_block_t)timer.handler;
+            handler();
+        }
+    }
+}
+
+@end
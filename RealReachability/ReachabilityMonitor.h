@@ -0,0 +1,52 @@
+//
+//  ReachabilityMonitor.h
+//  RealReachability
+//
+//  Created by agent on 26/10/19.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "RealReachability.h"
+
+///Posted when reachability of one monitor really changed; we post the monitor itself.
+extern NSString *const kReachabilityMonitorChangedNotification;
+
+/**
+ *  Reachability of a set of endpoints (regional API hosts, CDN edges...).
+ *  Every monitor owns its FSM, targets and schedule, while all of the monitors
+ *  share one PingEngine and one LocalConnection; so hundreds of monitors are cheap,
+ *  and monitors watching the same host send only one ping.
+ */
+@interface ReachabilityMonitor : NSObject
+
+/// Hosts of this monitor, pinged concurrently; reachable if any of them responds.
+@property (nonatomic, copy) NSArray *hosts;
+
+/// Interval in minutes; default is 2.0f, the same limit as RealReachability.
+@property (nonatomic, assign) float autoCheckInterval;
+
+// Timeout used for ping. Default is 2 seconds
+@property (nonatomic, assign) NSTimeInterval pingTimeout;
+
+// Latency from latest ping result (the fastest host)
+@property (nonatomic, assign) NSTimeInterval latency;
+
+- (instancetype)initWithHosts:(NSArray *)hosts;
+
+- (void)startNotifier;
+
+- (void)stopNotifier;
+
+/**
+ *  Ping all hosts of this monitor, then make a double check if all of them failed.
+ *
+ *  @param asyncHandler async request handler, called on main thread.
+ */
+- (void)reachabilityWithBlock:(void (^)(ReachabilityStatus status))asyncHandler;
+
+- (ReachabilityStatus)currentReachabilityStatus;
+
+- (ReachabilityStatus)previousReachabilityStatus;
+
+@end
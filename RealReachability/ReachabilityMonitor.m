@@ -0,0 +1,396 @@
+//
+//  ReachabilityMonitor.m
+//  RealReachability
+//
+//  Created by agent on 26/10/19.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#import "ReachabilityMonitor.h"
+#import "FSMEngine.h"
+#import "FSMStateUtil.h"
+#import "PingEngine.h"
+#import "TimerWheel.h"
+#import <UIKit/UIKit.h>
+
+#if (!defined(DEBUG))
+#define NSLog(...)
+#endif
+
+#define kDefaultCheckInterval 2.0f
+#define kDefaultPingTimeout 2.0f
+
+#define kMinAutoCheckInterval 0.3f
+#define kMaxAutoCheckInterval 60.0f
+
+NSString *const kReachabilityMonitorChangedNotification = @"kReachabilityMonitorChangedNotification";
+
+/// Count of notifying monitors, the shared LocalConnection keeps notifying until it reaches zero.
+static NSUInteger sNotifyingMonitorCount = 0;
+
+@interface ReachabilityMonitor()
+
+@property (nonatomic, strong) FSMEngine *engine;
+@property (nonatomic, assign) BOOL isNotifying;
+@property (nonatomic, assign) ReachabilityStatus previousStatus;
+@property (nonatomic, assign) TimerWheelHandle autoCheckTimer;
+
+@property (nonatomic, weak) LocalConnection *localObserver;
+
+@end
+
+@implementation ReachabilityMonitor
+
+#pragma mark - Life Circle
+
+- (instancetype)initWithHosts:(NSArray *)hosts
+{
+    if ((self = [super init]))
+    {
+        _engine = [[FSMEngine alloc] init];
+        [_engine start];
+        
+        _hosts = [hosts copy];
+        _autoCheckInterval = kDefaultCheckInterval;
+        _pingTimeout = kDefaultPingTimeout;
+        _previousStatus = RealStatusUnknown;
+        
+        _localObserver = [LocalConnection sharedInstance];
+    }
+    return self;
+}
+
+- (id)init
+{
+    return [self initWithHosts:nil];
+}
+
+- (void)dealloc
+{
+    [self stopNotifier];
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+}
+
+#pragma mark - Handle system event
+
+- (void)appBecomeActive
+{
+    if (self.isNotifying)
+    {
+        [self reachabilityWithBlock:nil];
+    }
+}
+
+#pragma mark - actions
+
+- (void)startNotifier
+{
+    if (self.isNotifying)
+    {
+        // avoid duplicate action
+        return;
+    }
+    
+    self.isNotifying = YES;
+    self.previousStatus = RealStatusUnknown;
+    
+    NSDictionary *inputDic = @{kEventKeyID:@(RREventLoad)};
+    [self.engine receiveInput:inputDic];
+    
+    [[NSNotificationCenter defaultCenter] addObserver:self
+                                             selector:@selector(appBecomeActive)
+                                                 name:UIApplicationDidBecomeActiveNotification
+                                               object:nil];
+    [[NSNotificationCenter defaultCenter] addObserver:self
+                                             selector:@selector(localConnectionHandler:)
+                                                 name:kLocalConnectionChangedNotification
+                                               object:self.localObserver];
+    
+    BOOL isFirstMonitor = NO;
+    @synchronized([ReachabilityMonitor class])
+    {
+        isFirstMonitor = (sNotifyingMonitorCount == 0);
+        sNotifyingMonitorCount++;
+    }
+    
+    if (isFirstMonitor)
+    {
+        [self.localObserver startNotifier];
+    }
+    
+    // The shared observer may be already initialized, feed the local status directly.
+    [self handleLocalStatus:[self.localObserver currentLocalConnectionStatus] postNotification:NO];
+    
+    [self autoCheckReachability];
+}
+
+- (void)stopNotifier
+{
+    if (!self.isNotifying)
+    {
+        // avoid duplicate action
+        return;
+    }
+    
+    [[NSNotificationCenter defaultCenter] removeObserver:self
+                                                    name:UIApplicationDidBecomeActiveNotification
+                                                  object:nil];
+    [[NSNotificationCenter defaultCenter] removeObserver:self
+                                                    name:kLocalConnectionChangedNotification
+                                                  object:self.localObserver];
+    
+    NSDictionary *inputDic = @{kEventKeyID:@(RREventUnLoad)};
+    [self.engine receiveInput:inputDic];
+    
+    [[TimerWheel sharedWheel] cancelTimer:self.autoCheckTimer];
+    self.autoCheckTimer = kTimerWheelInvalidHandle;
+    
+    BOOL isLastMonitor = NO;
+    @synchronized([ReachabilityMonitor class])
+    {
+        sNotifyingMonitorCount--;
+        isLastMonitor = (sNotifyingMonitorCount == 0);
+    }
+    
+    if (isLastMonitor)
+    {
+        [self.localObserver stopNotifier];
+    }
+    
+    self.isNotifying = NO;
+}
+
+#pragma mark - outside invoke
+
+- (void)reachabilityWithBlock:(void (^)(ReachabilityStatus status))asyncHandler
+{
+    // no need to ping when Local connection unavailable!
+    if ([self.localObserver currentLocalConnectionStatus] == LC_UnReachable)
+    {
+        if (asyncHandler != nil)
+        {
+            asyncHandler(RealStatusNotReachable);
+        }
+        return;
+    }
+    
+    // special case, VPN on; just skipping (ICMP not working now).
+    if ([LocalConnection isVPNConnected])
+    {
+        if (asyncHandler != nil)
+        {
+            asyncHandler([self currentReachabilityStatus]);
+        }
+        return;
+    }
+    
+    __weak __typeof(self)weakSelf = self;
+    [self pingHostsWithBlock:^(BOOL isSuccess, NSTimeInterval latency) {
+        __strong __typeof(weakSelf)strongSelf = weakSelf;
+        if (strongSelf == nil)
+        {
+            return;
+        }
+        
+        if (isSuccess)
+        {
+            [strongSelf handlePingResult:YES latency:latency handler:asyncHandler];
+        }
+        else
+        {
+            // delay 1 seconds, then make a double check.
+            [[TimerWheel sharedWheel] armTimerWithDelay:1 handler:^{
+                __strong __typeof(weakSelf)strongSelf = weakSelf;
+                [strongSelf pingHostsWithBlock:^(BOOL isSuccess, NSTimeInterval latency) {
+                    __strong __typeof(weakSelf)strongSelf = weakSelf;
+                    [strongSelf handlePingResult:isSuccess latency:latency handler:asyncHandler];
+                }];
+            }];
+        }
+    }];
+}
+
+- (ReachabilityStatus)currentReachabilityStatus
+{
+    switch (self.engine.currentStateID)
+    {
+        case RRStateUnReachable:
+        {
+            return RealStatusNotReachable;
+        }
+        case RRStateWIFI:
+        {
+            return RealStatusViaWiFi;
+        }
+        case RRStateWWAN:
+        {
+            return RealStatusViaWWAN;
+        }
+        case RRStateLoading:
+        {
+            // status on loading, return local status temporary.
+            return (ReachabilityStatus)(self.localObserver.currentLocalConnectionStatus);
+        }
+            
+        default:
+        {
+            NSLog(@"No normal status matched, return unreachable temporary");
+            return RealStatusNotReachable;
+        }
+    }
+}
+
+- (ReachabilityStatus)previousReachabilityStatus
+{
+    return self.previousStatus;
+}
+
+#pragma mark - inner methods
+
+/// Ping all of the hosts concurrently; success once any host responds.
+/// Completion is called on main thread.
+- (void)pingHostsWithBlock:(void (^)(BOOL isSuccess, NSTimeInterval latency))completion
+{
+    if (![[NSThread currentThread] isMainThread])
+    {
+        __weak __typeof(self)weakSelf = self;
+        dispatch_async(dispatch_get_main_queue(), ^{
+            __strong __typeof(weakSelf)strongSelf = weakSelf;
+            [strongSelf pingHostsWithBlock:completion];
+        });
+        return;
+    }
+    
+    NSArray *hosts = self.hosts;
+    if (hosts.count == 0)
+    {
+        NSLog(@"ReachabilityMonitor error! no host to ping!");
+        completion(NO, 0);
+        return;
+    }
+    
+    __block NSUInteger pendingCount = hosts.count;
+    __block BOOL isFinished = NO;
+    for (NSString *host in hosts)
+    {
+        [[PingEngine sharedEngine] pingHost:host timeout:self.pingTimeout completion:^(BOOL isSuccess, NSTimeInterval latency) {
+            pendingCount--;
+            if (isFinished)
+            {
+                return;
+            }
+            
+            if (isSuccess || pendingCount == 0)
+            {
+                isFinished = YES;
+                completion(isSuccess, latency);
+            }
+        }];
+    }
+}
+
+- (void)handlePingResult:(BOOL)isSuccess
+                 latency:(NSTimeInterval)latency
+                 handler:(void (^)(ReachabilityStatus status))asyncHandler
+{
+    self.latency = latency;
+    ReachabilityStatus status = [self currentReachabilityStatus];
+    
+    NSString *localValue = [FSMStateUtil paramValueFromStatus:[self.localObserver currentLocalConnectionStatus]];
+    NSDictionary *inputDic = @{kEventKeyID:@(RREventPingCallback), kEventKeyParam:@(isSuccess),
+                               kEventKeyLocalParam:localValue};
+    NSInteger rtn = [self.engine receiveInput:inputDic];
+    BOOL shouldPost = NO;
+    if (rtn == 0) // state changed & state available, post notification.
+    {
+        if ([self.engine isCurrentStateAvailable])
+        {
+            self.previousStatus = status;
+            shouldPost = YES;
+        }
+    }
+    
+    // The ping helper is shared and still calling its blocks,
+    // observers and handler may start a new check on it: call them later.
+    ReachabilityStatus currentStatus = [self currentReachabilityStatus];
+    __weak __typeof(self)weakSelf = self;
+    dispatch_async(dispatch_get_main_queue(), ^{
+        __strong __typeof(weakSelf)strongSelf = weakSelf;
+        if (shouldPost && strongSelf != nil)
+        {
+            [[NSNotificationCenter defaultCenter] postNotificationName:kReachabilityMonitorChangedNotification
+                                                                object:strongSelf];
+        }
+    
+        if (asyncHandler != nil)
+        {
+            asyncHandler(currentStatus);
+        }
+    });
+}
+
+- (void)handleLocalStatus:(LocalConnectionStatus)lcStatus postNotification:(BOOL)shouldPost
+{
+    ReachabilityStatus status = [self currentReachabilityStatus];
+    
+    NSDictionary *inputDic = @{kEventKeyID:@(RREventLocalConnectionCallback), kEventKeyParam:[FSMStateUtil paramValueFromStatus:lcStatus]};
+    NSInteger rtn = [self.engine receiveInput:inputDic];
+    
+    if (rtn == 0) // state changed & state available, post notification.
+    {
+        if ([self.engine isCurrentStateAvailable])
+        {
+            self.previousStatus = status;
+            
+            if (shouldPost)
+            {
+                [[NSNotificationCenter defaultCenter] postNotificationName:kReachabilityMonitorChangedNotification
+                                                                    object:self];
+            }
+            
+            if (lcStatus != LC_UnReachable)
+            {
+                // To make sure your reachability is "Real".
+                [self reachabilityWithBlock:nil];
+            }
+        }
+    }
+}
+
+// auto checking after every autoCheckInterval minutes
+- (void)autoCheckReachability
+{
+    if (!self.isNotifying)
+    {
+        return;
+    }
+    
+    if (self.autoCheckInterval < kMinAutoCheckInterval)
+    {
+        self.autoCheckInterval = kMinAutoCheckInterval;
+    }
+    
+    if (self.autoCheckInterval > kMaxAutoCheckInterval)
+    {
+        self.autoCheckInterval = kMaxAutoCheckInterval;
+    }
+    
+    // only one auto checking timer for each monitor.
+    [[TimerWheel sharedWheel] cancelTimer:self.autoCheckTimer];
+    __weak __typeof(self)weakSelf = self;
+    self.autoCheckTimer = [[TimerWheel sharedWheel] armTimerWithDelay:self.autoCheckInterval*60 handler:^{
+        __strong __typeof(weakSelf)strongSelf = weakSelf;
+        [strongSelf reachabilityWithBlock:nil];
+        [strongSelf autoCheckReachability];
+    }];
+}
+
+#pragma mark - Notification observer
+
+- (void)localConnectionHandler:(NSNotification *)notification
+{
+    LocalConnection *lc = (LocalConnection *)notification.object;
+    [self handleLocalStatus:[lc currentLocalConnectionStatus] postNotification:YES];
+}
+
+@end
@@ -68,6 +68,36 @@ typedef NS_ENUM(NSInteger, WWANAccessType) {
 - (BOOL)doubleCheckByCustomAgent;
 @end
 
+/// Handle of a deadline probe, returned by reachabilityWithDeadline:block:.
+@interface RealReachabilityProbe : NSObject
+
+@property (nonatomic, assign, readonly) BOOL isCancelled;
+
+/**
+ *  The handler will never be called after cancel;
+ *  the ping and the pending checks are stopped at once (socket and resolver released).
+ */
+- (void)cancel;
+
+@end
+
+/// Result of one network path (interface), see reachabilityOfPathsWithBlock:.
+@interface RealReachabilityPath : NSObject
+
+/// BSD name of the interface, e.g. en0 or pdp_ip0.
+@property (nonatomic, copy, readonly) NSString *interfaceName;
+
+/// RealStatusViaWiFi, RealStatusViaWWAN, or RealStatusUnknown for other interfaces (wired, bridge, veth...).
+@property (nonatomic, assign, readonly) ReachabilityStatus pathType;
+
+/// YES if hostForPing or hostForCheck answered through this interface.
+@property (nonatomic, assign, readonly) BOOL isReachable;
+
+/// Latency of the ping through this interface, 0 if not reachable.
+@property (nonatomic, assign, readonly) NSTimeInterval latency;
+
+@end
+
 @interface RealReachability : NSObject
 
 // local connection observer
@@ -99,11 +129,57 @@ typedef NS_ENUM(NSInteger, WWANAccessType) {
  *  then we use the block blow for invoker to handle business request(need real reachability).
  *  Now we have introduced a double check to make our result more reliable.
  *
- *  @param asyncHandler async request handler, return in 5 seconds(max limit).
- *  The limit time may be adjusted later for better experience.
+ *  @param asyncHandler async request handler; with the double check it may take
+ *  pingTimeout + 1 second + pingTimeout. Use reachabilityWithDeadline:block: to bound the wait.
  */
 - (void)reachabilityWithBlock:(void (^)(ReachabilityStatus status))asyncHandler;
 
+/**
+ *  Same check as reachabilityWithBlock:, but never returns later than the deadline.
+ *  Pings always run with pingTimeout, the double check is skipped if it can not start in time.
+ *  When the budget runs out, the best available answer is returned:
+ *  the status of the latest check, or local status while loading;
+ *  the pending ping is cancelled, so a short budget never changes the global status.
+ *
+ *  @param deadline     absolute deadline of the handler
+ *  @param asyncHandler async request handler, called once unless the probe was cancelled.
+ *
+ *  @return probe handle, cancel it when the result is no longer needed.
+ */
+- (RealReachabilityProbe *)reachabilityWithDeadline:(NSDate *)deadline
+                                              block:(void (^)(ReachabilityStatus status))asyncHandler;
+
+/**
+ *  Measure every available path at the same time, each ping bound to its own interface.
+ *  Unlike reachabilityWithBlock:, a dead WiFi does not hide a working WWAN:
+ *  the local connection only sees the default route, this sees all of them.
+ *  A path failing on hostForPing is retried on hostForCheck at once (no delay).
+ *  The global status is not changed by this check.
+ *  Each path looks the hosts up through its own interface (within pingTimeout),
+ *  so a dead default route (no DNS) does not fail the other paths, even on the first check.
+ *
+ *  @param asyncHandler called on main thread when all paths are done;
+ *  bestPath is nil if no path is reachable.
+ */
+- (void)reachabilityOfPathsWithBlock:(void (^)(NSArray *paths, RealReachabilityPath *bestPath))asyncHandler;
+
+/**
+ *  Same as reachabilityOfPathsWithBlock:, on the given interfaces only.
+ *
+ *  @param interfaceNames names of the interfaces to measure, e.g. @[@"en0", @"pdp_ip0"]
+ *  @param asyncHandler   see reachabilityOfPathsWithBlock:
+ */
+- (void)reachabilityOfInterfaces:(NSArray *)interfaceNames
+                           block:(void (^)(NSArray *paths, RealReachabilityPath *bestPath))asyncHandler;
+
+/**
+ *  Interfaces able to carry traffic now: up & running, not loopback, not VPN,
+ *  with an IPv4 or a routable IPv6 address.
+ *
+ *  @return names of the interfaces, in the order of the system.
+ */
+- (NSArray *)currentPathInterfaces;
+
 /**
  *  Return current reachability immediately.
  *
@@ -7,10 +7,14 @@
 //
 
 #include <ifaddrs.h>
+#include <net/if.h>
+#include <netinet/in.h>
 
 #import "RealReachability.h"
 #import "FSMEngine.h"
-#import "PingHelper.h"
+#import "FSMStateUtil.h"
+#import "PingEngine.h"
+#import "TimerWheel.h"
 #import <UIKit/UIKit.h>
 #import <CoreTelephony/CTTelephonyNetworkInfo.h>
 
@@ -25,10 +29,121 @@
 #define kMinAutoCheckInterval 0.3f
 #define kMaxAutoCheckInterval 60.0f
 
+#define kDoubleCheckDelay 1.0f
+/// A ping with less budget than this is not worth sending.
+#define kMinProbeBudget 0.05f
+
 NSString *const kRealReachabilityChangedNotification = @"kRealReachabilityChangedNotification";
 
 NSString *const kRRVPNStatusChangedNotification = @"kRRVPNStatusChangedNotification";
 
+@interface RealReachabilityProbe()
+
+@property (nonatomic, assign, readwrite) BOOL isCancelled;
+@property (nonatomic, assign) BOOL isFinished;
+@property (nonatomic, copy) void (^handler)(ReachabilityStatus status);
+@property (nonatomic, strong) NSDate *deadline;
+
+/// Resources below are touched on main thread only.
+@property (nonatomic, strong) id pingToken;
+@property (nonatomic, assign) TimerWheelHandle deadlineTimer;
+@property (nonatomic, assign) TimerWheelHandle doubleCheckTimer;
+
+- (BOOL)isDone;
+- (void)finishWithStatus:(ReachabilityStatus)status;
+
+@end
+
+@implementation RealReachabilityProbe
+
+- (BOOL)isDone
+{
+    @synchronized(self)
+    {
+        return self.isFinished || self.isCancelled;
+    }
+}
+
+- (void)finishWithStatus:(ReachabilityStatus)status
+{
+    void (^handler)(ReachabilityStatus status) = nil;
+    @synchronized(self)
+    {
+        if (self.isFinished || self.isCancelled)
+        {
+            return;
+        }
+        self.isFinished = YES;
+        handler = self.handler;
+        self.handler = nil;
+    }
+    
+    [self releaseResources];
+    
+    if (handler != nil)
+    {
+        handler(status);
+    }
+}
+
+- (void)cancel
+{
+    @synchronized(self)
+    {
+        if (self.isFinished || self.isCancelled)
+        {
+            return;
+        }
+        self.isCancelled = YES;
+        self.handler = nil;
+    }
+    
+    [self releaseResources];
+}
+
+- (void)releaseResources
+{
+    if (![[NSThread currentThread] isMainThread])
+    {
+        dispatch_async(dispatch_get_main_queue(), ^{
+            [self releaseResources];
+        });
+        return;
+    }
+    
+    [[TimerWheel sharedWheel] cancelTimer:self.deadlineTimer];
+    self.deadlineTimer = kTimerWheelInvalidHandle;
+    [[TimerWheel sharedWheel] cancelTimer:self.doubleCheckTimer];
+    self.doubleCheckTimer = kTimerWheelInvalidHandle;
+    
+    if (self.pingToken != nil)
+    {
+        [[PingEngine sharedEngine] cancelPing:self.pingToken];
+        self.pingToken = nil;
+    }
+}
+
+@end
+
+@interface RealReachabilityPath()
+
+@property (nonatomic, copy, readwrite) NSString *interfaceName;
+@property (nonatomic, assign, readwrite) ReachabilityStatus pathType;
+@property (nonatomic, assign, readwrite) BOOL isReachable;
+@property (nonatomic, assign, readwrite) NSTimeInterval latency;
+
+@end
+
+@implementation RealReachabilityPath
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %@ type:%@ reachable:%@ latency:%.1f>",
+            NSStringFromClass([self class]), self.interfaceName, @(self.pathType), @(self.isReachable), self.latency];
+}
+
+@end
+
 @interface RealReachability()
 {
     BOOL _vpnFlag;
@@ -43,12 +158,7 @@ NSString *const kRRVPNStatusChangedNotification = @"kRRVPNStatusChangedNotificat
 @property (nonatomic,strong) NSArray *typeStrings2G;
 
 @property (nonatomic, assign) ReachabilityStatus previousStatus;
-
-/// main helper
-@property (nonatomic, strong) PingHelper *pingHelper;
-
-/// for double check
-@property (nonatomic, strong) PingHelper *pingChecker;
+@property (nonatomic, assign) TimerWheelHandle autoCheckTimer;
 
 @end
 
@@ -92,8 +202,6 @@ NSString *const kRRVPNStatusChangedNotification = @"kRRVPNStatusChangedNotificat
                                                    object:nil];
         
         _localObserver = [[LocalConnection alloc] init];
-        _pingHelper = [[PingHelper alloc] init];
-        _pingChecker = [[PingHelper alloc] init];
     }
     return self;
 }
@@ -151,17 +259,11 @@ NSString *const kRRVPNStatusChangedNotification = @"kRRVPNStatusChangedNotificat
     [[NSNotificationCenter defaultCenter] addObserver:self
                                              selector:@selector(localConnectionHandler:)
                                                  name:kLocalConnectionChangedNotification
-                                               object:nil];
+                                               object:self.localObserver];
     [[NSNotificationCenter defaultCenter] addObserver:self
                                              selector:@selector(localConnectionHandler:)
                                                  name:kLocalConnectionInitializedNotification
-                                               object:nil];
-    
-    self.pingHelper.host = _hostForPing;
-    self.pingHelper.timeout = self.pingTimeout;
-    
-    self.pingChecker.host = _hostForCheck;
-    self.pingChecker.timeout = self.pingTimeout;
+                                               object:self.localObserver];
     
     [self autoCheckReachability];
 }
@@ -176,14 +278,17 @@ NSString *const kRRVPNStatusChangedNotification = @"kRRVPNStatusChangedNotificat
     
     [[NSNotificationCenter defaultCenter] removeObserver:self
                                                     name:kLocalConnectionChangedNotification
-                                                  object:nil];
+                                                  object:self.localObserver];
     [[NSNotificationCenter defaultCenter] removeObserver:self
                                                     name:kLocalConnectionInitializedNotification
-                                                  object:nil];
+                                                  object:self.localObserver];
     
     NSDictionary *inputDic = @{kEventKeyID:@(RREventUnLoad)};
     [self.engine receiveInput:inputDic];
     
+    [[TimerWheel sharedWheel] cancelTimer:self.autoCheckTimer];
+    self.autoCheckTimer = kTimerWheelInvalidHandle;
+    
     [self.localObserver stopNotifier];
     
     self.isNotifying = NO;
@@ -215,30 +320,18 @@ NSString *const kRRVPNStatusChangedNotification = @"kRRVPNStatusChangedNotificat
     }
     
     __weak __typeof(self)weakSelf = self;
-    [self.pingHelper pingWithBlock:^(BOOL isSuccess, NSTimeInterval latency)
+    [[PingEngine sharedEngine] pingHost:self.hostForPing timeout:self.pingTimeout completion:^(BOOL isSuccess, NSTimeInterval latency)
      {
          __strong __typeof(weakSelf)strongSelf = weakSelf;
+         if (strongSelf == nil)
+         {
+             return;
+         }
          strongSelf.latency = latency;
          if (isSuccess)
          {
-             ReachabilityStatus status = [self currentReachabilityStatus];
-             
              // Post the notification if the state changed here.
-             NSDictionary *inputDic = @{kEventKeyID:@(RREventPingCallback), kEventKeyParam:@(YES)};
-             NSInteger rtn = [strongSelf.engine receiveInput:inputDic];
-             if (rtn == 0) // state changed & state available, post notification.
-             {
-                 if ([strongSelf.engine isCurrentStateAvailable])
-                 {
-                     strongSelf.previousStatus = status;
-                     __weak __typeof(self)weakSelf = strongSelf;
-                     dispatch_async(dispatch_get_main_queue(), ^{
-                         __strong __typeof(weakSelf)strongSelf = weakSelf;
-                         [[NSNotificationCenter defaultCenter] postNotificationName:kRealReachabilityChangedNotification
-                                                                             object:strongSelf];
-                     });
-                 }
-             }
+             [strongSelf updateWithPingResult:YES];
             
              if (asyncHandler != nil)
              {
@@ -255,17 +348,160 @@ NSString *const kRRVPNStatusChangedNotification = @"kRRVPNStatusChangedNotificat
              else
              {
                  // delay 1 seconds, then make a double check.
-                 dispatch_time_t time = dispatch_time(DISPATCH_TIME_NOW, (int64_t)(1*NSEC_PER_SEC));
                  __weak __typeof(self)weakSelf = self;
-                 dispatch_after(time, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+                 [[TimerWheel sharedWheel] armTimerWithDelay:kDoubleCheckDelay handler:^{
                      __strong __typeof(weakSelf)self = weakSelf;
                      [self makeDoubleCheck:asyncHandler];
-                 });
+                 }];
              }
          }
      }];
 }
 
+- (RealReachabilityProbe *)reachabilityWithDeadline:(NSDate *)deadline
+                                              block:(void (^)(ReachabilityStatus status))asyncHandler
+{
+    RealReachabilityProbe *probe = [[RealReachabilityProbe alloc] init];
+    probe.handler = asyncHandler;
+    probe.deadline = deadline;
+    
+    // logic optimization: no need to ping when Local connection unavailable!
+    if ([self.localObserver currentLocalConnectionStatus] == LC_UnReachable)
+    {
+        [probe finishWithStatus:RealStatusNotReachable];
+        return probe;
+    }
+    
+    // special case, VPN on; or no budget for a ping.
+    if ([self isVPNOn] || [deadline timeIntervalSinceNow] < kMinProbeBudget)
+    {
+        [probe finishWithStatus:[self currentReachabilityStatus]];
+        return probe;
+    }
+    
+    // MUST make sure pinging in mainThread
+    if ([[NSThread currentThread] isMainThread])
+    {
+        [self startProbe:probe];
+    }
+    else
+    {
+        __weak __typeof(self)weakSelf = self;
+        dispatch_async(dispatch_get_main_queue(), ^{
+            __strong __typeof(weakSelf)strongSelf = weakSelf;
+            [strongSelf startProbe:probe];
+        });
+    }
+    
+    return probe;
+}
+
+- (void)reachabilityOfPathsWithBlock:(void (^)(NSArray *paths, RealReachabilityPath *bestPath))asyncHandler
+{
+    [self reachabilityOfInterfaces:[self currentPathInterfaces] block:asyncHandler];
+}
+
+- (void)reachabilityOfInterfaces:(NSArray *)interfaceNames
+                           block:(void (^)(NSArray *paths, RealReachabilityPath *bestPath))asyncHandler
+{
+    // MUST make sure pinging in mainThread
+    if (![[NSThread currentThread] isMainThread])
+    {
+        __weak __typeof(self)weakSelf = self;
+        dispatch_async(dispatch_get_main_queue(), ^{
+            __strong __typeof(weakSelf)strongSelf = weakSelf;
+            [strongSelf reachabilityOfInterfaces:interfaceNames block:asyncHandler];
+        });
+        return;
+    }
+    
+    NSMutableArray *paths = [NSMutableArray array];
+    for (NSString *interfaceName in interfaceNames)
+    {
+        RealReachabilityPath *path = [[RealReachabilityPath alloc] init];
+        path.interfaceName = interfaceName;
+        path.pathType = [self pathTypeForInterface:interfaceName];
+        [paths addObject:path];
+    }
+    
+    if (paths.count == 0)
+    {
+        if (asyncHandler != nil)
+        {
+            asyncHandler(paths, nil);
+        }
+        return;
+    }
+    
+    // all paths at the same time; counted on main thread only.
+    __block NSUInteger pendingCount = paths.count;
+    __weak __typeof(self)weakSelf = self;
+    void (^pathDone)(void) = ^{
+        pendingCount--;
+        if (pendingCount == 0 && asyncHandler != nil)
+        {
+            __strong __typeof(weakSelf)strongSelf = weakSelf;
+            asyncHandler(paths, [strongSelf bestPathOfPaths:paths]);
+        }
+    };
+    
+    for (RealReachabilityPath *path in paths)
+    {
+        [self path:path pingHost:self.hostForPing isDoubleCheck:NO completion:pathDone];
+    }
+}
+
+- (NSArray *)currentPathInterfaces
+{
+    NSMutableArray *interfaceNames = [NSMutableArray array];
+    struct ifaddrs *interfaces = NULL;
+    struct ifaddrs *temp_addr = NULL;
+    
+    // retrieve the current interfaces - returns 0 on success
+    if (getifaddrs(&interfaces) != 0)
+    {
+        return interfaceNames;
+    }
+    
+    for (temp_addr = interfaces; temp_addr != NULL; temp_addr = temp_addr->ifa_next)
+    {
+        if (temp_addr->ifa_addr == NULL ||
+            (temp_addr->ifa_flags & IFF_UP) == 0 ||
+            (temp_addr->ifa_flags & IFF_RUNNING) == 0 ||
+            (temp_addr->ifa_flags & IFF_LOOPBACK) != 0)
+        {
+            continue;
+        }
+        
+        // a link-local IPv6 address only (e.g. awdl0) can not reach our hosts.
+        sa_family_t family = temp_addr->ifa_addr->sa_family;
+        if (family == AF_INET6)
+        {
+            struct sockaddr_in6 *address = (struct sockaddr_in6 *)temp_addr->ifa_addr;
+            if (IN6_IS_ADDR_LINKLOCAL(&address->sin6_addr))
+            {
+                continue;
+            }
+        }
+        else if (family != AF_INET)
+        {
+            continue;
+        }
+        
+        NSString *interfaceName = [NSString stringWithUTF8String:temp_addr->ifa_name];
+        if (interfaceName == nil || [LocalConnection isVPNInterface:interfaceName] || [interfaceNames containsObject:interfaceName])
+        {
+            continue;
+        }
+        [interfaceNames addObject:interfaceName];
+    }
+    
+    // Free memory
+    freeifaddrs(interfaces);
+    
+    return interfaceNames;
+}
+
 - (ReachabilityStatus)currentReachabilityStatus
 {
     RRStateID currentID = self.engine.currentStateID;
@@ -303,29 +539,6 @@ NSString *const kRRVPNStatusChangedNotification = @"kRRVPNStatusChangedNotificat
     return self.previousStatus;
 }
 
-- (void)setHostForPing:(NSString *)hostForPing
-{
-    _hostForPing = nil;
-    _hostForPing = [hostForPing copy];
-    
-    self.pingHelper.host = _hostForPing;
-}
-
-- (void)setHostForCheck:(NSString *)hostForCheck
-{
-    _hostForCheck = nil;
-    _hostForCheck = [hostForCheck copy];
-    
-    self.pingChecker.host = _hostForCheck;
-}
-
-- (void)setPingTimeout:(NSTimeInterval)pingTimeout
-{
-    _pingTimeout = pingTimeout;
-    self.pingHelper.timeout = pingTimeout;
-    self.pingChecker.timeout = pingTimeout;
-}
-
 - (WWANAccessType)currentWWANtype
 {
     if ([[[UIDevice currentDevice] systemVersion] floatValue] >= 7.0)
@@ -367,26 +580,14 @@ NSString *const kRRVPNStatusChangedNotification = @"kRRVPNStatusChangedNotificat
 - (void)makeDoubleCheck:(void (^)(ReachabilityStatus status))asyncHandler
 {
     __weak __typeof(self)weakSelf = self;
-    [self.pingChecker pingWithBlock:^(BOOL isSuccess, NSTimeInterval latency) {
+    [[PingEngine sharedEngine] pingHost:self.hostForCheck timeout:self.pingTimeout completion:^(BOOL isSuccess, NSTimeInterval latency) {
         __strong __typeof(weakSelf)strongSelf = weakSelf;
-        strongSelf.latency = latency;
-        ReachabilityStatus status = [strongSelf currentReachabilityStatus];
-        
-        NSDictionary *inputDic = @{kEventKeyID:@(RREventPingCallback), kEventKeyParam:@(isSuccess)};
-        NSInteger rtn = [strongSelf.engine receiveInput:inputDic];
-        if (rtn == 0) // state changed & state available, post notification.
+        if (strongSelf == nil)
         {
-            if ([strongSelf.engine isCurrentStateAvailable])
-            {
-                strongSelf.previousStatus = status;
-                __weak __typeof(self)weakSelf = strongSelf;
-                dispatch_async(dispatch_get_main_queue(), ^{
-                    __strong __typeof(weakSelf)strongSelf = weakSelf;
-                    [[NSNotificationCenter defaultCenter] postNotificationName:kRealReachabilityChangedNotification
-                                                                        object:strongSelf];
-                });
-            }
+            return;
         }
+        strongSelf.latency = latency;
+        [strongSelf updateWithPingResult:isSuccess];
         
         if (asyncHandler != nil)
         {
@@ -396,29 +597,165 @@ NSString *const kRRVPNStatusChangedNotification = @"kRRVPNStatusChangedNotificat
     }];
 }
 
-- (NSString *)paramValueFromStatus:(LocalConnectionStatus)status
+/// Feed the ping result to FSM, post the notification if state changed.
+- (void)updateWithPingResult:(BOOL)isSuccess
 {
-    switch (status)
+    ReachabilityStatus status = [self currentReachabilityStatus];
+    
+    NSDictionary *inputDic = @{kEventKeyID:@(RREventPingCallback), kEventKeyParam:@(isSuccess),
+                               kEventKeyLocalParam:[self localParamValue]};
+    NSInteger rtn = [self.engine receiveInput:inputDic];
+    if (rtn == 0) // state changed & state available, post notification.
     {
-        case LC_UnReachable:
+        if ([self.engine isCurrentStateAvailable])
         {
-            return kParamValueUnReachable;
+            self.previousStatus = status;
+            __weak __typeof(self)weakSelf = self;
+            dispatch_async(dispatch_get_main_queue(), ^{
+                __strong __typeof(weakSelf)strongSelf = weakSelf;
+                [[NSNotificationCenter defaultCenter] postNotificationName:kRealReachabilityChangedNotification
+                                                                    object:strongSelf];
+            });
         }
-        case LC_WiFi:
+    }
+}
+
+- (void)startProbe:(RealReachabilityProbe *)probe
+{
+    if ([probe isDone])
+    {
+        return;
+    }
+    
+    // When the budget runs out, answer with the best we have now.
+    // The probe is retained by its timers and ping until released, callers may drop the handle.
+    __weak __typeof(self)weakSelf = self;
+    probe.deadlineTimer = [[TimerWheel sharedWheel] armTimerWithDelay:[probe.deadline timeIntervalSinceNow] handler:^{
+        __strong __typeof(weakSelf)strongSelf = weakSelf;
+        [probe finishWithStatus:[strongSelf currentReachabilityStatus]];
+    }];
+    
+    [self probe:probe pingHost:self.hostForPing isDoubleCheck:NO];
+}
+
+- (void)probe:(RealReachabilityProbe *)probe pingHost:(NSString *)host isDoubleCheck:(BOOL)isDoubleCheck
+{
+    if ([probe isDone])
+    {
+        return;
+    }
+    
+    // Always the full timeout: a ping cut short fails on a slow network, and that failure
+    // would move the global FSM. The deadline timer bounds the wait instead.
+    __weak __typeof(self)weakSelf = self;
+    probe.pingToken = [[PingEngine sharedEngine] pingHost:host timeout:self.pingTimeout completion:^(BOOL isSuccess, NSTimeInterval latency) {
+        __strong __typeof(weakSelf)strongSelf = weakSelf;
+        probe.pingToken = nil;
+        if (strongSelf == nil)
         {
-          return kParamValueWIFI;
+            return;
         }
-        case LC_WWAN:
+        strongSelf.latency = latency;
+        
+        if (isSuccess || isDoubleCheck)
         {
-            return kParamValueWWAN;
+            [strongSelf updateWithPingResult:isSuccess];
+            [probe finishWithStatus:[strongSelf currentReachabilityStatus]];
+            return;
         }
-           
-        default:
+        
+        // VPN connected(ping result ignored), or no budget for the double check.
+        NSTimeInterval remaining = [probe.deadline timeIntervalSinceNow];
+        if ([strongSelf isVPNOn] || remaining < kDoubleCheckDelay + kMinProbeBudget)
+        {
+            [probe finishWithStatus:[strongSelf currentReachabilityStatus]];
+            return;
+        }
+        
+        probe.doubleCheckTimer = [[TimerWheel sharedWheel] armTimerWithDelay:kDoubleCheckDelay handler:^{
+            __strong __typeof(weakSelf)strongSelf = weakSelf;
+            probe.doubleCheckTimer = kTimerWheelInvalidHandle;
+            [strongSelf probe:probe pingHost:strongSelf.hostForCheck isDoubleCheck:YES];
+        }];
+    }];
+}
+
+- (void)path:(RealReachabilityPath *)path
+    pingHost:(NSString *)host
+isDoubleCheck:(BOOL)isDoubleCheck
+  completion:(void (^)(void))completion
+{
+    __weak __typeof(self)weakSelf = self;
+    [[PingEngine sharedEngine] pingHost:host interface:path.interfaceName timeout:self.pingTimeout completion:^(BOOL isSuccess, NSTimeInterval latency) {
+        __strong __typeof(weakSelf)strongSelf = weakSelf;
+        if (!isSuccess && !isDoubleCheck && strongSelf != nil)
+        {
+            [strongSelf path:path pingHost:strongSelf.hostForCheck isDoubleCheck:YES completion:completion];
+            return;
+        }
+        
+        path.isReachable = isSuccess;
+        path.latency = isSuccess ? latency : 0;
+        completion();
+    }];
+}
+
+/// WWAN costs money and battery: any other reachable path goes first, then the lower latency.
+- (RealReachabilityPath *)bestPathOfPaths:(NSArray *)paths
+{
+    RealReachabilityPath *bestPath = nil;
+    for (RealReachabilityPath *path in paths)
+    {
+        if (!path.isReachable)
+        {
+            continue;
+        }
+        
+        if (bestPath == nil)
+        {
+            bestPath = path;
+            continue;
+        }
+        
+        BOOL isWWAN = (path.pathType == RealStatusViaWWAN);
+        BOOL isBestWWAN = (bestPath.pathType == RealStatusViaWWAN);
+        if (isWWAN != isBestWWAN)
+        {
+            if (!isWWAN)
+            {
+                bestPath = path;
+            }
+        }
+        else if (path.latency < bestPath.latency)
         {
-            NSLog(@"RealReachability error! paramValueFromStatus not matched!");
-            return @"";
+            bestPath = path;
         }
     }
+    return bestPath;
+}
+
+- (ReachabilityStatus)pathTypeForInterface:(NSString *)interfaceName
+{
+    // en0 is WiFi on iPhone & iPad (other enX are wired adapters); wlX/wlanX on Linux & Android.
+    if ([interfaceName isEqualToString:@"en0"] || [interfaceName hasPrefix:@"wl"])
+    {
+        return RealStatusViaWiFi;
+    }
+    
+    for (NSString *prefix in @[@"pdp_ip", @"rmnet", @"wwan", @"ccmni"])
+    {
+        if ([interfaceName hasPrefix:prefix])
+        {
+            return RealStatusViaWWAN;
+        }
+    }
+    
+    return RealStatusUnknown;
+}
+
+- (NSString *)localParamValue
+{
+    return [FSMStateUtil paramValueFromStatus:[self.localObserver currentLocalConnectionStatus]];
 }
 
 // auto checking after every autoCheckInterval minutes
@@ -439,14 +776,14 @@ NSString *const kRRVPNStatusChangedNotification = @"kRRVPNStatusChangedNotificat
         self.autoCheckInterval = kMaxAutoCheckInterval;
     }
     
-    
-    dispatch_time_t time = dispatch_time(DISPATCH_TIME_NOW, (int64_t)(self.autoCheckInterval*60*NSEC_PER_SEC));
+    // only one auto checking timer for each instance.
+    [[TimerWheel sharedWheel] cancelTimer:self.autoCheckTimer];
     __weak __typeof(self)weakSelf = self;
-    dispatch_after(time, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+    self.autoCheckTimer = [[TimerWheel sharedWheel] armTimerWithDelay:self.autoCheckInterval*60 handler:^{
         __strong __typeof(weakSelf)strongSelf = weakSelf;
         [strongSelf reachabilityWithBlock:nil];
         [strongSelf autoCheckReachability];
-    });
+    }];
 }
 
 - (WWANAccessType)accessTypeForString:(NSString *)accessString
@@ -481,7 +818,7 @@ NSString *const kRRVPNStatusChangedNotification = @"kRRVPNStatusChangedNotificat
     //NSLog(@"currentLocalConnectionStatus:%@, receive notification:%@",@(lcStatus), notification.name);
     ReachabilityStatus status = [self currentReachabilityStatus];
     
-    NSDictionary *inputDic = @{kEventKeyID:@(RREventLocalConnectionCallback), kEventKeyParam:[self paramValueFromStatus:lcStatus]};
+    NSDictionary *inputDic = @{kEventKeyID:@(RREventLocalConnectionCallback), kEventKeyParam:[FSMStateUtil paramValueFromStatus:lcStatus]};
     NSInteger rtn = [self.engine receiveInput:inputDic];
     
     if (rtn == 0) // state changed & state available, post notification.
@@ -508,53 +845,7 @@ NSString *const kRRVPNStatusChangedNotification = @"kRRVPNStatusChangedNotificat
 
 - (BOOL)isVPNOn
 {
-    BOOL flag = NO;
-    NSString *version = [UIDevice currentDevice].systemVersion;
-    // need two ways to judge this.
-    if (version.doubleValue >= 9.0)
-    {
-        NSDictionary *dict = CFBridgingRelease(CFNetworkCopySystemProxySettings());
-        NSArray *keys = [dict[@"__SCOPED__"] allKeys];
-        for (NSString *key in keys) {
-            if ([key rangeOfString:@"tap"].location != NSNotFound ||
-                [key rangeOfString:@"tun"].location != NSNotFound ||
-                [key rangeOfString:@"ipsec"].location != NSNotFound ||
-                [key rangeOfString:@"ppp"].location != NSNotFound){
-                flag = YES;
-                break;
-            }
-        }
-    }
-    else
-    {
-        struct ifaddrs *interfaces = NULL;
-        struct ifaddrs *temp_addr = NULL;
-        int success = 0;
-        
-        // retrieve the current interfaces - returns 0 on success
-        success = getifaddrs(&interfaces);
-        if (success == 0)
-        {
-            // Loop through linked list of interfaces
-            temp_addr = interfaces;
-            while (temp_addr != NULL)
-            {
-                NSString *string = [NSString stringWithFormat:@"%s" , temp_addr->ifa_name];
-                if ([string rangeOfString:@"tap"].location != NSNotFound ||
-                    [string rangeOfString:@"tun"].location != NSNotFound ||
-                    [string rangeOfString:@"ipsec"].location != NSNotFound ||
-                    [string rangeOfString:@"ppp"].location != NSNotFound)
-                {
-                    flag = YES;
-                    break;
-                }
-                temp_addr = temp_addr->ifa_next;
-            }
-        }
-        
-        // Free memory
-        freeifaddrs(interfaces);
-    }
+    BOOL flag = [LocalConnection isVPNConnected];
     
     if (_vpnFlag != flag)
     {
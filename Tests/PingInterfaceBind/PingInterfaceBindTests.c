@@ -0,0 +1,116 @@
+//
+//  PingInterfaceBindTests.c
+//  RealReachability
+//  Linux test of PingBindSocketToInterface, run by run_netns_tests.sh inside a network namespace.
+//
+//  Created by agent on 26/10/19.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "PingInterfaceBind.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/ip_icmp.h>
+#include <errno.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+static int sFailureCount = 0;
+
+#define EXPECT(condition, ...) \
+    do { \
+        if (condition) { printf("ok   - "); } else { printf("FAIL - "); sFailureCount++; } \
+        printf(__VA_ARGS__); \
+        printf("\n"); \
+    } while (0)
+
+static int OpenPingSocket(void)
+{
+    return socket(AF_INET, SOCK_DGRAM, IPPROTO_ICMP);
+}
+
+/// Send one echo request through the socket; 1 if the reply came back in time, 0 otherwise.
+static int EchoThroughSocket(int fd, const char *address)
+{
+    struct sockaddr_in destination;
+    memset(&destination, 0, sizeof(destination));
+    destination.sin_family = AF_INET;
+    if (inet_pton(AF_INET, address, &destination.sin_addr) != 1)
+    {
+        return 0;
+    }
+    
+    // the kernel fills identifier and checksum of ping sockets.
+    struct icmphdr request;
+    memset(&request, 0, sizeof(request));
+    request.type = ICMP_ECHO;
+    request.un.echo.sequence = htons(1);
+    if (sendto(fd, &request, sizeof(request), 0, (struct sockaddr *)&destination, sizeof(destination)) < 0)
+    {
+        // e.g. ENETUNREACH: the bound interface has no route there.
+        return 0;
+    }
+    
+    struct pollfd pfd = { fd, POLLIN, 0 };
+    if (poll(&pfd, 1, 1000) <= 0)
+    {
+        return 0;
+    }
+    
+    struct icmphdr reply;
+    ssize_t length = recv(fd, &reply, sizeof(reply), 0);
+    return (length >= (ssize_t)sizeof(reply) && reply.type == ICMP_ECHOREPLY);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        fprintf(stderr, "usage: %s <interface> <peer address> [<interface without route to peer>...]\n", argv[0]);
+        return 2;
+    }
+    
+    const char *interfaceName = argv[1];
+    const char *peerAddress = argv[2];
+    
+    int fd = OpenPingSocket();
+    if (fd < 0)
+    {
+        fprintf(stderr, "can not open ping socket: %s (check net.ipv4.ping_group_range)\n", strerror(errno));
+        return 2;
+    }
+    
+    int err = PingBindSocketToInterface(fd, AF_INET, "rr-nosuch0");
+    EXPECT(err == ENXIO, "unknown interface returns ENXIO (got %d)", err);
+    
+    err = PingBindSocketToInterface(fd, AF_INET, "");
+    EXPECT(err == EINVAL, "empty interface name returns EINVAL (got %d)", err);
+    close(fd);
+    
+    // control: without binding the peer is reached through the default route.
+    fd = OpenPingSocket();
+    EXPECT(EchoThroughSocket(fd, peerAddress), "echo to %s without binding is answered", peerAddress);
+    close(fd);
+    
+    fd = OpenPingSocket();
+    err = PingBindSocketToInterface(fd, AF_INET, interfaceName);
+    EXPECT(err == 0, "bind to %s succeeds (got %d)", interfaceName, err);
+    EXPECT(EchoThroughSocket(fd, peerAddress), "echo to %s through %s is answered", peerAddress, interfaceName);
+    close(fd);
+    
+    // the same peer must not be reached through the other interfaces.
+    for (int i = 3; i < argc; i++)
+    {
+        fd = OpenPingSocket();
+        err = PingBindSocketToInterface(fd, AF_INET, argv[i]);
+        EXPECT(err == 0, "bind to %s succeeds (got %d)", argv[i], err);
+        EXPECT(!EchoThroughSocket(fd, peerAddress), "echo to %s through %s is not answered", peerAddress, argv[i]);
+        close(fd);
+    }
+    
+    printf("%d failure(s)\n", sFailureCount);
+    return (sFailureCount == 0) ? 0 : 1;
+}
@@ -0,0 +1,65 @@
+#!/bin/sh
+#
+# Runs PingInterfaceBindTests in throwaway network namespaces (Linux, root, iproute2):
+#
+#   rr-test-a: rr-veth0 10.200.0.1/24  <-- veth -->  rr-test-b: rr-veth1 10.200.0.2/24
+#              rr-dummy0 10.201.0.1/24 (if the kernel has the dummy driver)
+#
+# Binding to rr-veth0 must reach 10.200.0.2; binding to lo or rr-dummy0 must not.
+
+set -eu
+
+HERE=$(cd "$(dirname "$0")" && pwd)
+PING_DIR="$HERE/../../RealReachability/Ping"
+NS_A=rr-test-a
+NS_B=rr-test-b
+BUILD_DIR=$(mktemp -d)
+
+cleanup_ns()
+{
+    ip netns del "$NS_A" 2>/dev/null || true
+    ip netns del "$NS_B" 2>/dev/null || true
+}
+
+cleanup()
+{
+    cleanup_ns
+    rm -rf "$BUILD_DIR"
+}
+trap cleanup EXIT
+
+if [ "$(id -u)" -ne 0 ]; then
+    echo "run as root (network namespaces are needed)" >&2
+    exit 2
+fi
+
+${CC:-cc} -Wall -Wextra -Werror -I"$PING_DIR" \
+    "$PING_DIR/PingInterfaceBind.c" "$HERE/PingInterfaceBindTests.c" \
+    -o "$BUILD_DIR/PingInterfaceBindTests"
+
+cleanup_ns
+ip netns add "$NS_A"
+ip netns add "$NS_B"
+
+ip -n "$NS_A" link set lo up
+ip -n "$NS_B" link set lo up
+ip -n "$NS_A" link add rr-veth0 type veth peer name rr-veth1 netns "$NS_B"
+ip -n "$NS_A" addr add 10.200.0.1/24 dev rr-veth0
+ip -n "$NS_B" addr add 10.200.0.2/24 dev rr-veth1
+ip -n "$NS_A" link set rr-veth0 up
+ip -n "$NS_B" link set rr-veth1 up
+
+UNROUTED="lo"
+if ip -n "$NS_A" link add rr-dummy0 type dummy 2>/dev/null; then
+    ip -n "$NS_A" addr add 10.201.0.1/24 dev rr-dummy0
+    ip -n "$NS_A" link set rr-dummy0 up
+    UNROUTED="$UNROUTED rr-dummy0"
+else
+    echo "note: no dummy driver, testing lo only"
+fi
+
+# unprivileged-style ICMP sockets, like the ones of PingFoundation.
+ip netns exec "$NS_A" sysctl -q -w net.ipv4.ping_group_range="0 2147483647"
+
+# shellcheck disable=SC2086
+ip netns exec "$NS_A" "$BUILD_DIR/PingInterfaceBindTests" rr-veth0 10.200.0.2 $UNROUTED
@@ -8,7 +8,11 @@
 
 #import "ViewController.h"
 #import "RealReachability.h"
+#import "ReachabilityMonitor.h"
+#import "PingEngine.h"
+#import "TimerWheel.h"
 #import "NSObject+SimpleKVO.h"
+#import <malloc/malloc.h>
 
 @interface ViewController ()
 
@@ -16,6 +20,8 @@
 
 @property (nonatomic, strong) UIAlertView *alert;
 
+@property (nonatomic, strong) NSMutableArray *benchmarkMonitors;
+
 @end
 
 @implementation ViewController
@@ -59,6 +65,17 @@
 //    }
 //    NSLog(@"end");
     
+//    // performance test of ReachabilityMonitor, memory & time from 50 to 500 endpoints.
+//    [self monitorBenchmarkWithEndpointCounts:@[@50, @100, @500]];
+    
+//    // performance test of TimerWheel with 100k armed timers.
+//    [self timerWheelBenchmarkWithTimerCount:100000];
+    
+//    // measure every path (WiFi & WWAN) at the same time.
+//    [GLobalRealReachability reachabilityOfPathsWithBlock:^(NSArray *paths, RealReachabilityPath *bestPath) {
+//        NSLog(@"paths:%@, best path:%@", paths, bestPath.interfaceName);
+//    }];
+    
     [GLobalRealReachability reachabilityWithBlock:^(ReachabilityStatus status) {
         switch (status)
         {
@@ -95,6 +112,165 @@
     }];
 }
 
+/// Bytes in use of all malloc zones.
+static size_t BenchmarkHeapInUse(void)
+{
+    malloc_statistics_t stats = {0};
+    malloc_zone_statistics(NULL, &stats);
+    return stats.size_in_use;
+}
+
+/// Run one round for each endpoint count in turn, so the heap deltas show how memory scales.
+- (void)monitorBenchmarkWithEndpointCounts:(NSArray *)endpointCounts
+{
+    [self monitorBenchmarkWithEndpointCounts:endpointCounts index:0 hostOffset:0];
+}
+
+- (void)monitorBenchmarkWithEndpointCounts:(NSArray *)endpointCounts
+                                     index:(NSUInteger)index
+                                hostOffset:(NSUInteger)hostOffset
+{
+    // release the monitors of the last round before measuring.
+    self.benchmarkMonitors = nil;
+    if (index >= endpointCounts.count)
+    {
+        return;
+    }
+    
+    NSUInteger endpointCount = [endpointCounts[index] unsignedIntegerValue];
+    PingEngine *engine = [PingEngine sharedEngine];
+    NSUInteger sentCount = engine.sentCount;
+    NSUInteger coalescedCount = engine.coalescedCount;
+    NSUInteger throttledCount = engine.throttledCount;
+    
+    // 198.18.0.0/15 is reserved for benchmarking, every ping here runs until timeout.
+    // Hosts never repeat between rounds, so each round pays for its own engine hosts.
+    size_t heapBegin = BenchmarkHeapInUse();
+    CFAbsoluteTime begin = CFAbsoluteTimeGetCurrent();
+    self.benchmarkMonitors = [NSMutableArray arrayWithCapacity:endpointCount];
+    for (NSUInteger i = hostOffset; i < hostOffset + endpointCount; i++)
+    {
+        NSString *host = [NSString stringWithFormat:@"198.18.%@.%@", @(i / 250), @(i % 250 + 1)];
+        [self.benchmarkMonitors addObject:[[ReachabilityMonitor alloc] initWithHosts:@[host]]];
+    }
+    CFAbsoluteTime created = CFAbsoluteTimeGetCurrent();
+    size_t heapCreated = BenchmarkHeapInUse();
+    
+    __weak __typeof(self)weakSelf = self;
+    __block NSUInteger pendingCount = endpointCount;
+    for (ReachabilityMonitor *monitor in self.benchmarkMonitors)
+    {
+        [monitor reachabilityWithBlock:^(ReachabilityStatus status) {
+            pendingCount--;
+            if (pendingCount > 0)
+            {
+                return;
+            }
+            
+            // Pacing: the requests over the global burst wait for tokens, whatever the engine costs.
+            NSUInteger sent = engine.sentCount - sentCount;
+            double pacingSeconds = MAX(0, (sent - engine.globalPingBurst) / engine.globalPingRate);
+            NSLog(@"[%@ endpoints] pacing: sent %@, coalesced %@, throttled %@; round %.0fms, at least %.0fms of it waiting for tokens",
+                  @(endpointCount), @(sent), @(engine.coalescedCount - coalescedCount),
+                  @(engine.throttledCount - throttledCount),
+                  (CFAbsoluteTimeGetCurrent() - created) * 1000, pacingSeconds * 1000);
+            
+            // next round out of the callback of this one.
+            dispatch_async(dispatch_get_main_queue(), ^{
+                __strong __typeof(weakSelf)strongSelf = weakSelf;
+                [strongSelf monitorBenchmarkWithEndpointCounts:endpointCounts
+                                                         index:index + 1
+                                                    hostOffset:hostOffset + endpointCount];
+            });
+        }];
+    }
+    CFAbsoluteTime probed = CFAbsoluteTimeGetCurrent();
+    
+    // Requests reach the engine on main thread, measure once they are all in.
+    dispatch_async(dispatch_get_main_queue(), ^{
+        size_t heapProbing = BenchmarkHeapInUse();
+        long monitorBytes = (long)heapCreated - (long)heapBegin;
+        long engineBytes = (long)heapProbing - (long)heapCreated;
+        NSLog(@"[%@ endpoints] engine: monitors %.2fms, %@ bytes (%@ per endpoint); "
+              @"probes issued %.2fms, %@ bytes (%@ per endpoint); engine holds %@ hosts",
+              @(endpointCount), (created - begin) * 1000, @(monitorBytes), @(monitorBytes / (long)MAX(endpointCount, 1)),
+              (probed - created) * 1000, @(engineBytes), @(engineBytes / (long)MAX(endpointCount, 1)),
+              @(engine.hostCount));
+    });
+}
+
+static void TimerWheelBenchmarkFire(void *context, TimerWheelHandle handle)
+{
+    NSUInteger *firedCount = (NSUInteger *)context;
+    (*firedCount)++;
+}
+
+/// Block timers capture per timer state like the real callers do, function timers allocate nothing.
+- (void)timerWheelBenchmarkWithTimerCount:(NSUInteger)timerCount
+{
+    [self timerWheelBenchmarkWithTimerCount:timerCount useFunction:NO];
+    [self timerWheelBenchmarkWithTimerCount:timerCount useFunction:YES];
+}
+
+- (void)timerWheelBenchmarkWithTimerCount:(NSUInteger)timerCount useFunction:(BOOL)useFunction
+{
+    dispatch_queue_t queue = dispatch_queue_create("com.dustturtle.timerwheel.benchmark", NULL);
+    TimerWheel *wheel = [[TimerWheel alloc] initWithQueue:queue];
+    TimerWheelHandle *handles = malloc(sizeof(TimerWheelHandle) * timerCount);
+    NSUInteger *firedCount = calloc(1, sizeof(NSUInteger));
+    if (handles == NULL || firedCount == NULL)
+    {
+        free(handles);
+        free(firedCount);
+        return;
+    }
+    NSString *kind = useFunction ? @"function" : @"block";
+    
+    // delays from 1ms to 10s, just like probe timeouts and double checks.
+    size_t heapBegin = BenchmarkHeapInUse();
+    CFAbsoluteTime begin = CFAbsoluteTimeGetCurrent();
+    for (NSUInteger i = 0; i < timerCount; i++)
+    {
+        NSTimeInterval delay = (arc4random_uniform(10000) + 1) / 1000.0;
+        if (useFunction)
+        {
+            handles[i] = [wheel armTimerWithDelay:delay function:TimerWheelBenchmarkFire context:firedCount];
+        }
+        else
+        {
+            // like the ping timeout: the handler captures its own ping.
+            NSUInteger pingID = i;
+            handles[i] = [wheel armTimerWithDelay:delay handler:^{
+                if (pingID < timerCount)
+                {
+                    (*firedCount)++;
+                }
+            }];
+        }
+    }
+    CFAbsoluteTime armed = CFAbsoluteTimeGetCurrent();
+    long armedBytes = (long)BenchmarkHeapInUse() - (long)heapBegin;
+    
+    // half of the probes answered in time.
+    NSUInteger cancelledCount = 0;
+    for (NSUInteger i = 0; i < timerCount; i += 2)
+    {
+        cancelledCount += [wheel cancelTimer:handles[i]] ? 1 : 0;
+    }
+    CFAbsoluteTime cancelled = CFAbsoluteTimeGetCurrent();
+    free(handles);
+    
+    NSLog(@"TimerWheel (%@): arm %@ in %.2fms, %@ bytes (%@ per timer, pool included); cancel %@ in %.2fms",
+          kind, @(timerCount), (armed - begin) * 1000, @(armedBytes), @(armedBytes / (long)MAX(timerCount, 1)),
+          @(cancelledCount), (cancelled - armed) * 1000);
+    
+    // wait for the rest to expire, then count them on the wheel queue.
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(11 * NSEC_PER_SEC)), queue, ^{
+        NSLog(@"TimerWheel (%@): %@ fired, %@ still armed", kind, @(*firedCount), @(wheel.armedCount));
+        free(firedCount);
+    });
+}
+
 - (void)networkChanged:(NSNotification *)notification
 {
     RealReachability *reachability = (RealReachability *)notification.object;